@@ -0,0 +1,267 @@
+#pragma once
+#include "variant.h"
+#include <memory>
+#include <memory_resource>
+
+namespace variant_utils {
+
+    template <size_t Index, typename Alloc, typename... Types, typename... Args>
+    variant_alternative_t<Index, variant<Types...>>& emplace_using_allocator(variant<Types...>& v, Alloc const& alloc,
+                                                                             Args&&... args) {
+        return std::apply(
+            [&v](auto&&... args) -> auto& { return v.template emplace<Index>(std::forward<decltype(args)>(args)...); },
+            std::uses_allocator_construction_args<variant_alternative_t<Index, variant<Types...>>>(
+                alloc, std::forward<Args>(args)...));
+    }
+
+} // namespace variant_utils
+
+template <typename Alloc, typename... Types>
+class allocator_variant {
+    using traits = std::allocator_traits<Alloc>;
+
+    template <size_t Index>
+    using alternative_type = variant_utils::type_at_t<Index, Types...>;
+
+public:
+    using allocator_type = Alloc;
+    using variant_type = variant<Types...>;
+
+    allocator_variant() requires(variant_utils::default_ctor<Types...>) : allocator_variant(Alloc()) {}
+
+    explicit allocator_variant(Alloc const& alloc) requires(variant_utils::default_ctor<Types...>)
+        : alloc(alloc), value(std::allocator_arg, alloc) {}
+
+    template <size_t Index, typename... Args>
+        requires(Index < sizeof...(Types) && variant_utils::uses_allocator_ctor<alternative_type<Index>, Alloc, Args...>)
+    explicit allocator_variant(in_place_index_t<Index>, Args&&... args)
+        : allocator_variant(std::allocator_arg, Alloc(), in_place_index<Index>, std::forward<Args>(args)...) {}
+
+    template <size_t Index, typename... Args>
+        requires(Index < sizeof...(Types) && variant_utils::uses_allocator_ctor<alternative_type<Index>, Alloc, Args...>)
+    allocator_variant(std::allocator_arg_t, Alloc const& alloc, in_place_index_t<Index>, Args&&... args)
+        : alloc(alloc), value(std::allocator_arg, alloc, in_place_index<Index>, std::forward<Args>(args)...) {}
+
+    template <typename T, typename... Args>
+        requires(variant_utils::exactly_once_v<T, Types...> && variant_utils::uses_allocator_ctor<T, Alloc, Args...>)
+    explicit allocator_variant(in_place_type_t<T>, Args&&... args)
+        : allocator_variant(std::allocator_arg, Alloc(), in_place_type<T>, std::forward<Args>(args)...) {}
+
+    template <typename T, typename... Args>
+        requires(variant_utils::exactly_once_v<T, Types...> && variant_utils::uses_allocator_ctor<T, Alloc, Args...>)
+    allocator_variant(std::allocator_arg_t, Alloc const& alloc, in_place_type_t<T>, Args&&... args)
+        : alloc(alloc), value(std::allocator_arg, alloc, in_place_type<T>, std::forward<Args>(args)...) {}
+
+    template <typename T>
+        requires(!std::is_same_v<std::decay_t<T>, allocator_variant> &&
+                 std::is_constructible_v<variant_type, std::allocator_arg_t, Alloc const&, T>)
+    allocator_variant(T&& t) : allocator_variant(std::allocator_arg, Alloc(), std::forward<T>(t)) {}
+
+    template <typename T>
+        requires(!std::is_same_v<std::decay_t<T>, allocator_variant> &&
+                 std::is_constructible_v<variant_type, std::allocator_arg_t, Alloc const&, T>)
+    allocator_variant(std::allocator_arg_t, Alloc const& alloc, T&& t)
+        : alloc(alloc), value(std::allocator_arg, alloc, std::forward<T>(t)) {}
+
+    allocator_variant(allocator_variant const& other)
+        : alloc(traits::select_on_container_copy_construction(other.alloc)),
+          value(std::allocator_arg, alloc, other.value) {}
+
+    allocator_variant(allocator_variant&& other) noexcept(variant_utils::nothrow_move_ctor<Types...>)
+        : alloc(other.alloc), value(std::move(other.value)) {}
+
+    allocator_variant(std::allocator_arg_t, Alloc const& alloc, allocator_variant const& other)
+        : alloc(alloc), value(std::allocator_arg, alloc, other.value) {}
+
+    allocator_variant(std::allocator_arg_t, Alloc const& alloc, allocator_variant&& other)
+        : alloc(alloc), value(std::allocator_arg, alloc, std::move(other.value)) {}
+
+    allocator_variant& operator=(allocator_variant const& other) {
+        if (this == &other) {
+            return *this;
+        }
+        if constexpr (traits::propagate_on_container_copy_assignment::value) {
+            if (alloc != other.alloc) {
+                alloc = other.alloc;
+                rebuild(other.value);
+                return *this;
+            }
+        }
+        assign(other.value);
+        return *this;
+    }
+
+    allocator_variant& operator=(allocator_variant&& other) noexcept(
+        (traits::propagate_on_container_move_assignment::value || traits::is_always_equal::value) &&
+        variant_utils::nothrow_move_assign<Types...>) {
+        if constexpr (traits::propagate_on_container_move_assignment::value) {
+            alloc = other.alloc;
+            value = std::move(other.value);
+        }
+        else {
+            if (alloc == other.alloc) {
+                value = std::move(other.value);
+            }
+            else {
+                assign(std::move(other.value));
+            }
+        }
+        return *this;
+    }
+
+    template <typename T>
+        requires(!std::is_same_v<std::decay_t<T>, allocator_variant> &&
+                 std::is_constructible_v<variant_utils::find_overload_t<T, Types...>, T>)
+    allocator_variant& operator=(T&& t) {
+        constexpr size_t Index = variant_utils::index_chooser_v<variant_utils::find_overload_t<T, Types...>, Types...>;
+        if (index() == Index) {
+            variant_utils::variant_access::get<Index>(value) = std::forward<T>(t);
+        }
+        else {
+            emplace<Index>(std::forward<T>(t));
+        }
+        return *this;
+    }
+
+    template <size_t Index, typename... Args>
+    alternative_type<Index>& emplace(Args&&... args) {
+        return variant_utils::emplace_using_allocator<Index>(value, alloc, std::forward<Args>(args)...);
+    }
+
+    template <typename T, typename... Args>
+    T& emplace(Args&&... args) {
+        return emplace<variant_utils::index_chooser_v<T, Types...>>(std::forward<Args>(args)...);
+    }
+
+    allocator_type get_allocator() const noexcept {
+        return alloc;
+    }
+
+    constexpr size_t index() const noexcept {
+        return value.index();
+    }
+
+    constexpr bool valueless_by_exception() const noexcept {
+        return value.valueless_by_exception();
+    }
+
+    void swap(allocator_variant& other) noexcept(noexcept(value.swap(other.value))) {
+        if constexpr (traits::propagate_on_container_swap::value) {
+            using std::swap;
+            swap(alloc, other.alloc);
+        }
+        value.swap(other.value);
+    }
+
+    friend void swap(allocator_variant& a, allocator_variant& b) noexcept(noexcept(a.swap(b))) {
+        a.swap(b);
+    }
+
+    friend bool operator==(allocator_variant const& a, allocator_variant const& b)
+        requires(std::equality_comparable<Types> && ...) {
+        return a.value == b.value;
+    }
+
+    friend auto operator<=>(allocator_variant const& a, allocator_variant const& b)
+        requires(std::three_way_comparable<Types> && ...) {
+        return a.value <=> b.value;
+    }
+
+private:
+    friend struct variant_utils::variant_access;
+
+    template <size_t Index>
+    constexpr auto& get(in_place_index_t<Index>) {
+        return variant_utils::variant_access::get<Index>(value);
+    }
+
+    template <size_t Index>
+    constexpr auto const& get(in_place_index_t<Index>) const {
+        return variant_utils::variant_access::get<Index>(value);
+    }
+
+    template <typename Variant>
+    void assign(Variant&& source) {
+        if (source.valueless_by_exception()) {
+            value = std::forward<Variant>(source);
+            return;
+        }
+        variant_utils::visit_index<void>(
+            [this, &source](auto index) {
+                auto&& alternative = variant_utils::variant_access::get<index>(std::forward<Variant>(source));
+                if (value.index() == index) {
+                    variant_utils::variant_access::get<index>(value) = std::forward<decltype(alternative)>(alternative);
+                }
+                else {
+                    emplace<index>(std::forward<decltype(alternative)>(alternative));
+                }
+            },
+            source);
+    }
+
+    void rebuild(variant_type const& source) {
+        if (source.valueless_by_exception()) {
+            value = source;
+            return;
+        }
+        variant_utils::visit_index<void>(
+            [this, &source](auto index) { emplace<index>(variant_utils::variant_access::get<index>(source)); }, source);
+    }
+
+    [[no_unique_address]] Alloc alloc;
+    variant_type value;
+};
+
+template <typename... Types>
+using pmr_variant = allocator_variant<std::pmr::polymorphic_allocator<>, Types...>;
+
+template <typename Alloc, typename... Types>
+struct variant_size<allocator_variant<Alloc, Types...>> : std::integral_constant<size_t, sizeof...(Types)> {};
+
+template <size_t Index, typename Alloc, typename... Types>
+struct variant_alternative<Index, allocator_variant<Alloc, Types...>> {
+    using type = variant_utils::type_at_t<Index, Types...>;
+};
+
+template <size_t Index, typename Alloc, class... Types>
+constexpr variant_alternative_t<Index, allocator_variant<Alloc, Types...>>& get(allocator_variant<Alloc, Types...>& v) {
+    variant_utils::check_access(Index == v.index());
+    return variant_utils::variant_access::get<Index>(v);
+}
+
+template <size_t Index, typename Alloc, class... Types>
+constexpr variant_alternative_t<Index, allocator_variant<Alloc, Types...>>&& get(allocator_variant<Alloc, Types...>&& v) {
+    return std::move(get<Index>(v));
+}
+
+template <size_t Index, typename Alloc, class... Types>
+constexpr const variant_alternative_t<Index, allocator_variant<Alloc, Types...>>&
+get(const allocator_variant<Alloc, Types...>& v) {
+    variant_utils::check_access(Index == v.index());
+    return variant_utils::variant_access::get<Index>(v);
+}
+
+template <class T, typename Alloc, class... Types>
+constexpr T& get(allocator_variant<Alloc, Types...>& v) {
+    return get<variant_utils::index_chooser_v<T, Types...>>(v);
+}
+
+template <class T, typename Alloc, class... Types>
+constexpr const T& get(const allocator_variant<Alloc, Types...>& v) {
+    return get<variant_utils::index_chooser_v<T, Types...>>(v);
+}
+
+template <size_t Index, typename Alloc, class... Types>
+constexpr auto get_if(allocator_variant<Alloc, Types...>* pv) noexcept {
+    return pv->index() == Index ? std::addressof(variant_utils::variant_access::get<Index>(*pv)) : nullptr;
+}
+
+template <size_t Index, typename Alloc, class... Types>
+constexpr auto get_if(const allocator_variant<Alloc, Types...>* pv) noexcept {
+    return pv->index() == Index ? std::addressof(variant_utils::variant_access::get<Index>(*pv)) : nullptr;
+}
+
+template <class T, typename Alloc, class... Types>
+constexpr bool holds_alternative(const allocator_variant<Alloc, Types...>& v) noexcept {
+    return v.index() == variant_utils::index_chooser_v<T, Types...>;
+}
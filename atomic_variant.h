@@ -0,0 +1,290 @@
+#pragma once
+#include "variant.h"
+#include <atomic>
+#include <bit>
+#include <cstring>
+#include <new>
+
+namespace variant_utils {
+
+    template <size_t Size>
+    class atomic_word;
+
+    template <>
+    class atomic_word<8> {
+    public:
+        using value_type = uint64_t;
+
+        static constexpr bool is_always_lock_free = std::atomic<uint64_t>::is_always_lock_free;
+
+        explicit atomic_word(value_type value) noexcept : word(value) {}
+
+        value_type load(std::memory_order order) const noexcept {
+            return word.load(order);
+        }
+
+        void store(value_type value, std::memory_order order) noexcept {
+            word.store(value, order);
+        }
+
+        value_type exchange(value_type value, std::memory_order order) noexcept {
+            return word.exchange(value, order);
+        }
+
+        bool compare_exchange_strong(value_type& expected, value_type desired, std::memory_order success,
+                                     std::memory_order failure) noexcept {
+            return word.compare_exchange_strong(expected, desired, success, failure);
+        }
+
+        bool compare_exchange_weak(value_type& expected, value_type desired, std::memory_order success,
+                                   std::memory_order failure) noexcept {
+            return word.compare_exchange_weak(expected, desired, success, failure);
+        }
+
+    private:
+        std::atomic<uint64_t> word;
+    };
+
+#if defined(__SIZEOF_INT128__)
+    template <>
+    class atomic_word<16> {
+    public:
+        __extension__ typedef unsigned __int128 value_type;
+
+#if defined(__GCC_HAVE_SYNC_COMPARE_AND_SWAP_16) || defined(__x86_64__)
+        static constexpr bool is_always_lock_free = true;
+
+        explicit atomic_word(value_type value) noexcept : word(value) {}
+
+        value_type load(std::memory_order) const noexcept {
+            return compare_and_swap(0, 0);
+        }
+
+        void store(value_type value, std::memory_order order) noexcept {
+            exchange(value, order);
+        }
+
+        value_type exchange(value_type value, std::memory_order order) noexcept {
+            value_type current = load(order);
+            for (;;) {
+                value_type previous = compare_and_swap(current, value);
+                if (previous == current) {
+                    return previous;
+                }
+                current = previous;
+            }
+        }
+
+        bool compare_exchange_strong(value_type& expected, value_type desired, std::memory_order,
+                                     std::memory_order) noexcept {
+            value_type previous = compare_and_swap(expected, desired);
+            if (previous == expected) {
+                return true;
+            }
+            expected = previous;
+            return false;
+        }
+
+        bool compare_exchange_weak(value_type& expected, value_type desired, std::memory_order success,
+                                   std::memory_order failure) noexcept {
+            return compare_exchange_strong(expected, desired, success, failure);
+        }
+
+    private:
+        value_type compare_and_swap(value_type expected, value_type desired) const noexcept {
+#if defined(__GCC_HAVE_SYNC_COMPARE_AND_SWAP_16)
+            return __sync_val_compare_and_swap(&word, expected, desired);
+#else
+            uint64_t low = static_cast<uint64_t>(expected);
+            uint64_t high = static_cast<uint64_t>(expected >> 64);
+            asm volatile("lock cmpxchg16b %0"
+                         : "+m"(word), "+a"(low), "+d"(high)
+                         : "b"(static_cast<uint64_t>(desired)), "c"(static_cast<uint64_t>(desired >> 64))
+                         : "cc", "memory");
+            return (value_type(high) << 64) | low;
+#endif
+        }
+
+        alignas(16) mutable value_type word;
+#else
+        static constexpr bool is_always_lock_free = std::atomic<value_type>::is_always_lock_free;
+
+        explicit atomic_word(value_type value) noexcept : word(value) {}
+
+        value_type load(std::memory_order order) const noexcept {
+            return word.load(order);
+        }
+
+        void store(value_type value, std::memory_order order) noexcept {
+            word.store(value, order);
+        }
+
+        value_type exchange(value_type value, std::memory_order order) noexcept {
+            return word.exchange(value, order);
+        }
+
+        bool compare_exchange_strong(value_type& expected, value_type desired, std::memory_order success,
+                                     std::memory_order failure) noexcept {
+            return word.compare_exchange_strong(expected, desired, success, failure);
+        }
+
+        bool compare_exchange_weak(value_type& expected, value_type desired, std::memory_order success,
+                                   std::memory_order failure) noexcept {
+            return word.compare_exchange_weak(expected, desired, success, failure);
+        }
+
+    private:
+        std::atomic<value_type> word;
+#endif
+    };
+#endif
+
+#if defined(__has_builtin)
+#if __has_builtin(__builtin_clear_padding)
+#define VARIANT_HAS_CLEAR_PADDING 1
+#endif
+#endif
+
+    template <typename T>
+    void clear_padding([[maybe_unused]] T& value) noexcept {
+#ifdef VARIANT_HAS_CLEAR_PADDING
+        __builtin_clear_padding(std::addressof(value));
+#else
+        static_assert(std::has_unique_object_representations_v<T> ||
+                          (std::is_floating_point_v<T> && !std::is_same_v<T, long double>),
+                      "atomic_variant: alternatives with padding need __builtin_clear_padding");
+#endif
+    }
+
+    constexpr std::memory_order failure_order(std::memory_order order) noexcept {
+        if (order == std::memory_order_acq_rel) {
+            return std::memory_order_acquire;
+        }
+        if (order == std::memory_order_release) {
+            return std::memory_order_relaxed;
+        }
+        return order;
+    }
+
+} // namespace variant_utils
+
+template <typename... Types>
+class atomic_variant {
+    static_assert((std::is_trivially_copyable_v<Types> && ...), "atomic_variant requires trivially copyable types");
+
+    using tag_type = variant_utils::index_type_t<sizeof...(Types)>;
+
+    static constexpr size_t payload_size = std::max({ sizeof(Types)... });
+    static constexpr size_t packed_size = payload_size + sizeof(tag_type);
+
+    static_assert(packed_size <= 16, "atomic_variant payload and tag must fit into 16 bytes");
+
+    using word_type = variant_utils::atomic_word<(packed_size <= 8 ? 8 : 16)>;
+    using bits_type = typename word_type::value_type;
+
+public:
+    using value_type = variant<Types...>;
+
+    static constexpr bool is_always_lock_free = word_type::is_always_lock_free;
+
+    atomic_variant() noexcept requires(variant_utils::default_ctor<Types...>) : atomic_variant(value_type()) {}
+
+    atomic_variant(value_type const& value) noexcept : word(pack(value)) {}
+
+    atomic_variant(atomic_variant const&) = delete;
+    atomic_variant& operator=(atomic_variant const&) = delete;
+
+    value_type operator=(value_type const& value) noexcept {
+        store(value);
+        return value;
+    }
+
+    operator value_type() const noexcept {
+        return load();
+    }
+
+    bool is_lock_free() const noexcept {
+        return is_always_lock_free;
+    }
+
+    value_type load(std::memory_order order = std::memory_order_seq_cst) const noexcept {
+        return unpack(word.load(order));
+    }
+
+    void store(value_type const& value, std::memory_order order = std::memory_order_seq_cst) noexcept {
+        word.store(pack(value), order);
+    }
+
+    value_type exchange(value_type const& value, std::memory_order order = std::memory_order_seq_cst) noexcept {
+        return unpack(word.exchange(pack(value), order));
+    }
+
+    bool compare_exchange_strong(value_type& expected, value_type const& desired, std::memory_order success,
+                                 std::memory_order failure) noexcept {
+        bits_type bits = pack(expected);
+        if (word.compare_exchange_strong(bits, pack(desired), success, failure)) {
+            return true;
+        }
+        expected = unpack(bits);
+        return false;
+    }
+
+    bool compare_exchange_strong(value_type& expected, value_type const& desired,
+                                 std::memory_order order = std::memory_order_seq_cst) noexcept {
+        return compare_exchange_strong(expected, desired, order, variant_utils::failure_order(order));
+    }
+
+    bool compare_exchange_weak(value_type& expected, value_type const& desired, std::memory_order success,
+                               std::memory_order failure) noexcept {
+        bits_type bits = pack(expected);
+        if (word.compare_exchange_weak(bits, pack(desired), success, failure)) {
+            return true;
+        }
+        expected = unpack(bits);
+        return false;
+    }
+
+    bool compare_exchange_weak(value_type& expected, value_type const& desired,
+                               std::memory_order order = std::memory_order_seq_cst) noexcept {
+        return compare_exchange_weak(expected, desired, order, variant_utils::failure_order(order));
+    }
+
+    template <typename Visitor>
+    decltype(auto) visit(Visitor&& vis, std::memory_order order = std::memory_order_seq_cst) const {
+        value_type snapshot = load(order);
+        return ::visit(std::forward<Visitor>(vis), snapshot);
+    }
+
+private:
+    using bytes_type = std::array<unsigned char, sizeof(bits_type)>;
+
+    static bits_type pack(value_type const& value) noexcept {
+        bytes_type bytes{};
+        variant_utils::visit_index<void>(
+            [&bytes, &value](auto index) {
+                auto alternative = variant_utils::variant_access::get<index>(value);
+                variant_utils::clear_padding(alternative);
+                std::memcpy(bytes.data(), std::addressof(alternative), sizeof(alternative));
+            },
+            value);
+        tag_type tag = static_cast<tag_type>(value.index());
+        std::memcpy(bytes.data() + payload_size, &tag, sizeof(tag));
+        return std::bit_cast<bits_type>(bytes);
+    }
+
+    static value_type unpack(bits_type bits) noexcept {
+        bytes_type bytes = std::bit_cast<bytes_type>(bits);
+        tag_type tag;
+        std::memcpy(&tag, bytes.data() + payload_size, sizeof(tag));
+        return variant_utils::visit_index<value_type>(
+            [&bytes](auto index) {
+                using T = variant_alternative_t<index, value_type>;
+                alignas(T) unsigned char buffer[sizeof(T)];
+                std::memcpy(buffer, bytes.data(), sizeof(T));
+                return value_type(in_place_index<index>, *std::launder(reinterpret_cast<T*>(buffer)));
+            },
+            variant_utils::index_holder<sizeof...(Types)>{ tag });
+    }
+
+    word_type word;
+};
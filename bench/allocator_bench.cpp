@@ -0,0 +1,76 @@
+#include "../allocator_variant.h"
+#include "harness.h"
+#include <array>
+#include <charconv>
+#include <cstdio>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+constexpr std::string_view request = "user=alice-the-administrator-of-everything\n"
+                                     "ids=1,2,3,5,8,13,21,34,55,89,144,233\n"
+                                     "count=42\n"
+                                     "path=/api/v2/accounts/alice/preferences/notifications\n"
+                                     "scores=100,200,300,400,500,600,700\n"
+                                     "limit=1000\n"
+                                     "agent=benchmark-client/1.0 (linux; x86_64; long user agent string)\n"
+                                     "tags=7,11,13,17,19,23,29,31\n";
+
+template <typename Fields>
+void parse(Fields& fields) {
+    std::string_view rest = request;
+    while (!rest.empty()) {
+        std::string_view line = rest.substr(0, rest.find('\n'));
+        rest.remove_prefix(line.size() + 1);
+        std::string_view value = line.substr(line.find('=') + 1);
+        int64_t number;
+        auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), number);
+        if (error == std::errc() && end == value.data() + value.size()) {
+            fields.emplace_back(in_place_index<0>, number);
+        }
+        else if (value.find(',') != std::string_view::npos && value[0] >= '0' && value[0] <= '9') {
+            auto& numbers = get<2>(fields.emplace_back(in_place_index<2>));
+            for (size_t start = 0; start < value.size();) {
+                size_t comma = std::min(value.find(',', start), value.size());
+                int parsed = 0;
+                std::from_chars(value.data() + start, value.data() + comma, parsed);
+                numbers.push_back(parsed);
+                start = comma + 1;
+            }
+        }
+        else {
+            fields.emplace_back(in_place_index<1>, value);
+        }
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    bench::runner runner(argc > 1 ? argv[1] : "");
+
+    using heap_field = variant<int64_t, std::string, std::vector<int>>;
+    double heap = runner.run("parse/global_heap", 1, [] {
+        std::vector<heap_field> fields;
+        parse(fields);
+        bench::do_not_optimize(fields);
+    });
+
+    using arena_field = pmr_variant<int64_t, std::pmr::string, std::pmr::vector<int>>;
+    double arena = runner.run("parse/monotonic_arena", 1, [] {
+        std::array<std::byte, 4096> buffer;
+        std::pmr::monotonic_buffer_resource resource(buffer.data(), buffer.size());
+        std::pmr::polymorphic_allocator<> alloc(&resource);
+        std::pmr::vector<arena_field> fields(alloc);
+        parse(fields);
+        bench::do_not_optimize(fields);
+    });
+
+    std::printf("%-24s %14s\n", "case", "ns/request");
+    std::printf("%-24s %14.1f\n", "global_heap", heap);
+    std::printf("%-24s %14.1f\n", "monotonic_arena", arena);
+    std::printf("%-24s %14.2f\n", "ratio", arena / heap);
+}
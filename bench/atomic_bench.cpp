@@ -0,0 +1,123 @@
+#include "../atomic_variant.h"
+#include "harness.h"
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct idle {};
+
+struct running {
+    uint32_t job;
+};
+
+struct failed {
+    uint16_t code;
+};
+
+struct progress {
+    uint32_t job;
+    uint32_t done;
+    uint32_t check;
+};
+
+using status = variant<idle, running, failed>;
+using wide_status = variant<idle, progress>;
+
+constexpr size_t ops_per_thread = 1 << 20;
+
+template <typename Body>
+void run_threads(size_t threads, Body body) {
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back(body, t);
+    }
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+void stress(size_t threads) {
+    atomic_variant<idle, running> counter(running{ 0 });
+    run_threads(threads, [&counter](size_t) {
+        for (size_t i = 0; i < ops_per_thread / 8; ++i) {
+            auto current = counter.load();
+            while (!counter.compare_exchange_weak(current, running{ get<running>(current).job + 1 })) {
+            }
+        }
+    });
+    bench::require(get<running>(counter.load()).job == threads * (ops_per_thread / 8), "lost compare_exchange update");
+
+    atomic_variant<idle, progress> shared;
+    run_threads(threads, [&shared](size_t t) {
+        for (uint32_t i = 0; i < ops_per_thread / 8; ++i) {
+            if (i % 4 == 0) {
+                shared.store(i % 8 == 0 ? wide_status(idle{}) : wide_status(progress{ uint32_t(t), i, uint32_t(t) ^ i }));
+            }
+            else {
+                wide_status snapshot = shared.load();
+                if (auto* p = get_if<progress>(&snapshot)) {
+                    bench::require((p->job ^ p->done) == p->check, "torn 16-byte load");
+                }
+            }
+        }
+    });
+}
+
+template <typename Shared>
+double contention(size_t threads, Shared& shared) {
+    auto start = std::chrono::steady_clock::now();
+    run_threads(threads, [&shared](size_t t) {
+        size_t seen = 0;
+        for (size_t i = 0; i < ops_per_thread; ++i) {
+            if (i % 16 == 0) {
+                shared.store(i % 32 == 0 ? status(running{ uint32_t(i) }) : status(failed{ uint16_t(t) }));
+            }
+            else {
+                seen += shared.load().index();
+            }
+        }
+        bench::do_not_optimize(seen);
+    });
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / double(threads * ops_per_thread);
+}
+
+class locked_status {
+public:
+    status load() const {
+        std::lock_guard lock(mutex);
+        return value;
+    }
+
+    void store(status const& v) {
+        std::lock_guard lock(mutex);
+        value = v;
+    }
+
+private:
+    mutable std::mutex mutex;
+    status value;
+};
+
+} // namespace
+
+int main() {
+    static_assert(atomic_variant<idle, running, failed>::is_always_lock_free);
+    static_assert(atomic_variant<idle, progress>::is_always_lock_free);
+
+    size_t hardware = std::max(2u, std::thread::hardware_concurrency());
+    stress(hardware);
+
+    std::printf("%-8s %16s %16s\n", "threads", "atomic ns/op", "mutex ns/op");
+    for (size_t threads = 1; threads <= hardware; threads *= 2) {
+        atomic_variant<idle, running, failed> atomic;
+        locked_status locked;
+        double a = contention(threads, atomic);
+        double m = contention(threads, locked);
+        std::printf("%-8zu %16.2f %16.2f\n", threads, a, m);
+    }
+}
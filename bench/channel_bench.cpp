@@ -0,0 +1,156 @@
+#include "../variant_channel.h"
+#include "harness.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+struct add_order {
+    int64_t sent;
+    uint64_t id;
+    uint64_t price;
+    uint32_t quantity;
+};
+
+struct cancel_order {
+    int64_t sent;
+    uint64_t id;
+};
+
+struct trade {
+    int64_t sent;
+    uint64_t id;
+    std::array<char, 40> venue;
+};
+
+using message = variant<add_order, cancel_order, trade>;
+
+constexpr size_t capacity = 1024;
+constexpr size_t message_count = 1 << 20;
+
+int64_t now() {
+    return clock_type::now().time_since_epoch().count();
+}
+
+void backoff(size_t& spins) {
+    if (++spins % 64 == 0) {
+        std::this_thread::yield();
+    }
+}
+
+template <typename Channel>
+void produce(Channel& channel, size_t count, size_t offset) {
+    for (size_t i = 0; i < count; ++i) {
+        size_t spins = 0;
+        uint64_t id = offset + i;
+        switch (i % 8) {
+        case 0:
+            while (!channel.template try_emplace<1>(cancel_order{ now(), id })) {
+                backoff(spins);
+            }
+            break;
+        case 1:
+            while (!channel.template try_emplace<2>(trade{ now(), id, {} })) {
+                backoff(spins);
+            }
+            break;
+        default:
+            while (!channel.template try_emplace<0>(add_order{ now(), id, id * 3, 100 })) {
+                backoff(spins);
+            }
+        }
+    }
+}
+
+class locked_queue {
+public:
+    explicit locked_queue(size_t) {}
+
+    template <size_t Index, typename... Args>
+    bool try_emplace(Args&&... args) {
+        std::lock_guard lock(mutex);
+        queue.emplace(in_place_index<Index>, std::forward<Args>(args)...);
+        return true;
+    }
+
+    template <typename Visitor>
+    bool try_visit(Visitor&& vis) {
+        message value;
+        {
+            std::lock_guard lock(mutex);
+            if (queue.empty()) {
+                return false;
+            }
+            value = std::move(queue.front());
+            queue.pop();
+        }
+        visit(std::forward<Visitor>(vis), value);
+        return true;
+    }
+
+private:
+    std::mutex mutex;
+    std::queue<message> queue;
+};
+
+struct report {
+    double ns_per_message;
+    double p50;
+    double p99;
+    double p999;
+};
+
+template <typename Channel>
+report run(size_t producers) {
+    Channel channel(capacity);
+    std::vector<int64_t> latencies;
+    latencies.reserve(message_count);
+    auto start = clock_type::now();
+    std::vector<std::thread> threads;
+    for (size_t p = 0; p < producers; ++p) {
+        threads.emplace_back([&channel, producers, p] {
+            produce(channel, message_count / producers, p * (message_count / producers));
+        });
+    }
+    size_t spins = 0;
+    while (latencies.size() < message_count) {
+        if (!channel.try_visit([&latencies](auto const& m) { latencies.push_back(now() - m.sent); })) {
+            backoff(spins);
+        }
+    }
+    std::chrono::duration<double, std::nano> elapsed = clock_type::now() - start;
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    std::sort(latencies.begin(), latencies.end());
+    auto percentile = [&latencies](double q) {
+        using period = clock_type::period;
+        return double(latencies[size_t(q * double(latencies.size() - 1))]) * 1e9 * period::num / period::den;
+    };
+    return { elapsed.count() / double(message_count), percentile(0.5), percentile(0.99), percentile(0.999) };
+}
+
+void print(char const* name, report const& r) {
+    std::printf("%-26s %12.1f %12.0f %12.0f %12.0f\n", name, r.ns_per_message, r.p50, r.p99, r.p999);
+}
+
+} // namespace
+
+int main() {
+    std::printf("%zu hardware threads, %zu messages of %zu bytes\n", size_t(std::thread::hardware_concurrency()),
+                message_count, sizeof(message));
+    std::printf("%-26s %12s %12s %12s %12s\n", "channel", "ns/message", "p50 ns", "p99 ns", "p99.9 ns");
+    print("spsc_variant_channel", run<spsc_variant_channel<add_order, cancel_order, trade>>(1));
+    print("mpsc_variant_channel x1", run<mpsc_variant_channel<add_order, cancel_order, trade>>(1));
+    print("mpsc_variant_channel x2", run<mpsc_variant_channel<add_order, cancel_order, trade>>(2));
+    print("mutex + std::queue x1", run<locked_queue>(1));
+    print("mutex + std::queue x2", run<locked_queue>(2));
+}
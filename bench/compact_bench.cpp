@@ -0,0 +1,98 @@
+#include "../compact_variant.h"
+#include "harness.h"
+#include <array>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct small_message {
+    uint64_t id;
+    uint64_t value;
+};
+
+struct large_message {
+    uint64_t id;
+    std::array<unsigned char, 504> body;
+};
+
+constexpr size_t count = 1 << 16;
+constexpr size_t large_every = 100;
+
+using plain = variant<small_message, large_message>;
+using compact = compact_variant<16, small_message, large_message>;
+
+void check_moved_from() {
+    using text = compact_variant<16, int, std::string>;
+    static_assert(std::is_nothrow_move_constructible_v<text> && std::is_nothrow_move_assignable_v<text>);
+    static_assert(std::is_nothrow_move_constructible_v<compact>);
+    std::string const payload(100, 'x');
+    text a(payload);
+    text b(std::move(a));
+    bench::require(get<1>(b) == payload, "move lost the payload");
+    bench::require(a.index() == 1, "moved-from value changed its alternative");
+    text c(a);
+    bench::require(c == a && a != b && a < b, "copy or comparison of a moved-from value mismatch");
+    a = b;
+    bench::require(get<1>(a) == payload, "copy assignment to a moved-from value mismatch");
+    b = c;
+    bench::require(b == c && b != a, "copy assignment from a moved-from value mismatch");
+    b = std::move(a);
+    bench::require(get<1>(b) == payload, "move assignment to a moved-from value mismatch");
+    a = text(payload);
+    bench::require(get<1>(a) == payload, "assignment after move mismatch");
+    std::vector<text> values(64, text(payload));
+    values.reserve(values.capacity() * 2);
+    for (text const& v : values) {
+        bench::require(get<1>(v) == payload, "reallocation lost a payload");
+    }
+}
+
+template <typename V>
+std::vector<V> fill() {
+    std::vector<V> result;
+    result.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        if (i % large_every == 0) {
+            result.emplace_back(in_place_index<1>, large_message{ i, {} });
+        }
+        else {
+            result.emplace_back(in_place_index<0>, small_message{ i, i * 3 });
+        }
+    }
+    return result;
+}
+
+template <typename V>
+uint64_t sum(std::vector<V> const& values) {
+    uint64_t result = 0;
+    for (V const& v : values) {
+        result += visit([](auto const& message) { return message.id; }, v);
+    }
+    return result;
+}
+
+template <typename V>
+void run(bench::runner& runner, char const* name) {
+    std::vector<V> const values = fill<V>();
+    size_t large = (count + large_every - 1) / large_every;
+    size_t bytes = count * sizeof(V) + (sizeof(V) < sizeof(large_message) ? large * sizeof(large_message) : 0);
+    double build = runner.run(std::string("build/") + name, count, [] { bench::do_not_optimize(fill<V>()); });
+    double copy = runner.run(std::string("copy/") + name, count, [&values] {
+        std::vector<V> copy = values;
+        bench::do_not_optimize(copy);
+    });
+    double visit = runner.run(std::string("visit/") + name, count, [&values] { bench::do_not_optimize(sum(values)); });
+    std::printf("%-16s %8zu %12.2f %12.2f %12.2f %12zu\n", name, sizeof(V), build, copy, visit, bytes);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    bench::runner runner(argc > 1 ? argv[1] : "");
+    check_moved_from();
+    std::printf("%-16s %8s %12s %12s %12s %12s\n", "type", "sizeof", "build ns", "copy ns", "visit ns", "bytes");
+    run<plain>(runner, "variant");
+    run<compact>(runner, "compact_variant");
+}
@@ -0,0 +1,37 @@
+#include "../variant.h"
+#include <utility>
+
+#ifndef ALTERNATIVES
+#define ALTERNATIVES 16
+#endif
+
+template <size_t Tag>
+struct alternative {
+    int value;
+};
+
+template <typename Indexes>
+struct make_variant;
+
+template <size_t... Indexes>
+struct make_variant<std::index_sequence<Indexes...>> {
+    using type = variant<alternative<Indexes>...>;
+};
+
+using V = make_variant<std::make_index_sequence<ALTERNATIVES>>::type;
+
+template <size_t... Indexes>
+int touch(std::index_sequence<Indexes...>) {
+    int sum = 0;
+    ((sum += [] {
+         V v = alternative<Indexes>{ int(Indexes) };
+         static_assert(std::is_same_v<variant_alternative_t<Indexes, V>, alternative<Indexes>>);
+         return holds_alternative<alternative<Indexes>>(v) ? get<Indexes>(v).value + get<alternative<Indexes>>(v).value : 0;
+     }()),
+     ...);
+    return sum;
+}
+
+int main() {
+    return touch(std::make_index_sequence<ALTERNATIVES>()) == 0 ? 0 : 1;
+}
@@ -0,0 +1,10 @@
+#!/bin/sh
+# Frontend time of bench/compile_bench.cpp for a sweep of alternative counts.
+CXX=${CXX:-g++}
+cd "$(dirname "$0")"
+for n in ${ALTERNATIVES:-16 64 256}; do
+    printf 'alternatives=%s ' "$n"
+    $CXX -std=c++20 -fsyntax-only -ftime-report -ftemplate-depth=4096 -DALTERNATIVES="$n" compile_bench.cpp 2>&1 |
+        grep -E '^ (template instantiation|TOTAL) ' | sed -E 's/ +/ /g' | tr '\n' ' '
+    echo
+done
@@ -0,0 +1,136 @@
+#include "../variant_serialization.h"
+#include "harness.h"
+#include <cstdio>
+#include <random>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+struct quote {
+    uint64_t id;
+    double bid;
+    double ask;
+
+    friend bool operator==(quote const&, quote const&) = default;
+};
+
+using message = variant<uint32_t, quote, std::string, std::vector<uint64_t>>;
+using decoder_type = variant_decoder<uint32_t, quote, std::string, std::vector<uint64_t>>;
+
+constexpr size_t count = 1 << 16;
+
+std::vector<message> make_messages() {
+    std::vector<message> result;
+    std::mt19937_64 random(42);
+    for (size_t i = 0; i < count; ++i) {
+        uint64_t r = random();
+        switch (r % 4) {
+        case 0:
+            result.emplace_back(in_place_index<0>, uint32_t(r >> 32));
+            break;
+        case 1:
+            result.emplace_back(in_place_index<1>, quote{ i, double(r % 1000), double(r % 1000) + 0.5 });
+            break;
+        case 2:
+            result.emplace_back(in_place_index<2>, std::string((r >> 8) % 300, char('a' + i % 26)));
+            break;
+        default:
+            result.emplace_back(in_place_index<3>, std::vector<uint64_t>((r >> 8) % 40, r));
+        }
+    }
+    return result;
+}
+
+std::vector<std::byte> encode(std::vector<message> const& messages) {
+    std::vector<std::byte> stream;
+    for (message const& m : messages) {
+        size_t offset = stream.size();
+        stream.resize(offset + serialized_size(m));
+        serialize(m, stream.data() + offset);
+    }
+    return stream;
+}
+
+void write_all(int fd, std::vector<std::byte> const& stream, uint64_t seed) {
+    std::mt19937_64 random(seed);
+    for (size_t offset = 0; offset < stream.size();) {
+        size_t chunk = std::min<size_t>(1 + random() % 4096, stream.size() - offset);
+        ssize_t written = ::write(fd, stream.data() + offset, chunk);
+        bench::require(written > 0, "write failed");
+        offset += size_t(written);
+    }
+    ::close(fd);
+}
+
+size_t read_and_decode(int fd, std::vector<message> const* expected, uint64_t seed) {
+    std::mt19937_64 random(seed);
+    std::vector<std::byte> buffer(8192);
+    decoder_type decoder(1 << 20);
+    message value;
+    size_t decoded = 0;
+    for (;;) {
+        size_t want = 1 + random() % buffer.size();
+        ssize_t received = ::read(fd, buffer.data(), want);
+        bench::require(received >= 0, "read failed");
+        if (received == 0) {
+            break;
+        }
+        std::span<std::byte const> in(buffer.data(), size_t(received));
+        while (!in.empty()) {
+            auto [status, consumed] = decoder.feed(in, value);
+            bench::require(status != decode_status::invalid, "decoder rejected a valid stream");
+            in = in.subspan(consumed);
+            if (status == decode_status::complete) {
+                if (expected != nullptr) {
+                    bench::require(decoded < expected->size() && value == (*expected)[decoded],
+                                   "decoded value mismatch");
+                }
+                ++decoded;
+            }
+        }
+    }
+    ::close(fd);
+    return decoded;
+}
+
+size_t transfer(std::vector<std::byte> const& stream, std::vector<message> const* expected, uint64_t seed) {
+    int fds[2];
+    bench::require(::socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0, "socketpair failed");
+    std::thread writer(write_all, fds[0], std::cref(stream), seed);
+    size_t decoded = read_and_decode(fds[1], expected, seed * 31 + 7);
+    writer.join();
+    return decoded;
+}
+
+void check_invalid() {
+    decoder_type decoder(64);
+    message value;
+    std::byte bad_tag[] = { std::byte{ 9 } };
+    bench::require(decoder.feed(bad_tag, value).status == decode_status::invalid, "invalid tag accepted");
+    decoder.reset();
+    std::vector<std::byte> long_string = encode({ message(in_place_index<2>, std::string(65, 'x')) });
+    bench::require(decoder.feed(long_string, value).status == decode_status::invalid, "oversized payload accepted");
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    bench::runner runner(argc > 1 ? argv[1] : "");
+    std::vector<message> const messages = make_messages();
+    std::vector<std::byte> const stream = encode(messages);
+    for (uint64_t seed = 1; seed <= 16; ++seed) {
+        bench::require(transfer(stream, &messages, seed) == messages.size(), "decoder lost messages");
+    }
+    check_invalid();
+
+    uint64_t seed = 100;
+    double ns = runner.run("socketpair/random_chunks", count, [&stream, &seed] {
+        bench::do_not_optimize(transfer(stream, nullptr, ++seed));
+    });
+    std::printf("%-28s %12s %12s\n", "case", "ns/message", "MB/s");
+    std::printf("%-28s %12.2f %12.1f\n", "socketpair/random_chunks", ns, double(stream.size()) / (ns * count) * 1e3);
+}
@@ -0,0 +1,60 @@
+#include "../variant.h"
+#include "harness.h"
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace {
+
+using value = variant<int64_t, double, std::string>;
+
+constexpr size_t count = 4096;
+
+std::vector<value> make_values() {
+    std::vector<value> result;
+    result.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        if (i % 4 == 3) {
+            result.emplace_back(in_place_index<2>, "sixteen chars..");
+        }
+        else {
+            result.emplace_back(in_place_index<0>, int64_t(i));
+        }
+    }
+    return result;
+}
+
+[[gnu::noinline]] int64_t sum_get(std::vector<value> const& values) {
+    int64_t sum = 0;
+    for (value const& v : values) {
+        sum += v.index() == 0 ? get<0>(v) : int64_t(get<std::string>(v).size());
+    }
+    return sum;
+}
+
+[[gnu::noinline]] int64_t sum_visit(std::vector<value> const& values) {
+    int64_t sum = 0;
+    for (value const& v : values) {
+        sum += visit(
+            [](auto const& x) -> int64_t {
+                if constexpr (std::is_same_v<std::decay_t<decltype(x)>, std::string>) {
+                    return int64_t(x.size());
+                }
+                else {
+                    return int64_t(x);
+                }
+            },
+            v);
+    }
+    return sum;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    bench::runner runner(argc > 1 ? argv[1] : "");
+    std::vector<value> const values = make_values();
+    double get_ns = runner.run("get", count, [&values] { bench::do_not_optimize(sum_get(values)); });
+    double visit_ns = runner.run("visit", count, [&values] { bench::do_not_optimize(sum_visit(values)); });
+    std::printf("%12.2f %12.2f\n", get_ns, visit_ns);
+}
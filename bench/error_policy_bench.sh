@@ -0,0 +1,21 @@
+#!/bin/sh
+# Code size and get/visit latency of bench/error_policy_bench.cpp under each access-failure policy.
+# variant_ops and serialization_bench are built and their checks run under every policy as well.
+CXX=${CXX:-g++}
+cd "$(dirname "$0")"
+out=$(mktemp -d)
+trap 'rm -rf "$out"' EXIT
+printf '%-10s %10s %12s %12s\n' policy text get_ns visit_ns
+for config in "throw:" \
+    "abort:-fno-exceptions" \
+    "unchecked:-fno-exceptions -DNDEBUG -DVARIANT_ERROR_POLICY=VARIANT_ERROR_UNCHECKED"; do
+    name=${config%%:*}
+    flags=${config#*:}
+    $CXX -std=c++20 -O2 $flags error_policy_bench.cpp -o "$out/$name" || exit 1
+    text=$(size "$out/$name" | awk 'NR == 2 { print $1 }')
+    printf '%-10s %10s %s\n' "$name" "$text" "$("$out/$name")"
+    for check in variant_ops serialization_bench; do
+        $CXX -std=c++20 -O2 $flags $check.cpp -o "$out/$check" || exit 1
+        "$out/$check" checks-only > /dev/null || exit 1
+    done
+done
@@ -0,0 +1,90 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+template <typename T>
+inline void do_not_optimize(T const& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "g"(&value) : "memory");
+#else
+    static void const* volatile sink;
+    sink = &value;
+#endif
+}
+
+inline void clobber() {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : : "memory");
+#endif
+}
+
+inline void require(bool condition, char const* what) {
+    if (!condition) {
+        std::fprintf(stderr, "check failed: %s\n", what);
+        std::abort();
+    }
+}
+
+struct result {
+    std::string name;
+    double ns_per_op;
+};
+
+class runner {
+public:
+    explicit runner(std::string filter = {}, double min_time_ms = 20.0, size_t repeats = 5)
+        : filter(std::move(filter)), min_time_ms(min_time_ms), repeats(repeats) {}
+
+    bool enabled(std::string const& name) const {
+        return filter.empty() || name.find(filter) != std::string::npos;
+    }
+
+    template <typename Body>
+    double run(std::string const& name, size_t ops_per_call, Body&& body) {
+        if (!enabled(name)) {
+            return 0;
+        }
+        size_t iterations = 1;
+        while (measure(body, iterations) < min_time_ms * 1e6 && iterations < (size_t(1) << 30)) {
+            iterations *= 2;
+        }
+        std::vector<double> samples;
+        for (size_t i = 0; i < repeats; ++i) {
+            samples.push_back(measure(body, iterations) / double(iterations * ops_per_call));
+        }
+        std::sort(samples.begin(), samples.end());
+        double median = samples[samples.size() / 2];
+        results.push_back({ name, median });
+        return median;
+    }
+
+    std::vector<result> const& all() const {
+        return results;
+    }
+
+private:
+    template <typename Body>
+    static double measure(Body& body, size_t iterations) {
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < iterations; ++i) {
+            body();
+            clobber();
+        }
+        auto finish = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::nano>(finish - start).count();
+    }
+
+    std::string filter;
+    double min_time_ms;
+    size_t repeats;
+    std::vector<result> results;
+};
+
+} // namespace bench
@@ -0,0 +1,105 @@
+#include "../variant.h"
+#include "harness.h"
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+template <int Kind, bool Hinted>
+struct message {
+    uint64_t id;
+    uint64_t price;
+
+    message(uint64_t id, uint64_t price) : id(id), price(price) {}
+    message(message const& other) : id(other.id), price(other.price) {}
+    message& operator=(message const& other) {
+        id = other.id;
+        price = other.price;
+        return *this;
+    }
+};
+
+template <bool Hinted, int... Kinds>
+using order_book_event = variant<message<Kinds, Hinted>...>;
+
+using uniform_event = order_book_event<false, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11>;
+using hinted_event = order_book_event<true, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11>;
+
+} // namespace
+
+template <>
+struct hot_alternatives<hinted_event> {
+    using type = std::index_sequence<0>;
+};
+
+namespace {
+
+constexpr size_t count = 4096;
+
+template <typename Event, size_t... Kinds>
+std::vector<Event> make_events(std::index_sequence<Kinds...>) {
+    std::vector<Event> result;
+    uint32_t state = 12345;
+    for (size_t i = 0; i < count; ++i) {
+        state = state * 1664525u + 1013904223u;
+        size_t kind = (state >> 8) % 100 < 90 ? 0 : 1 + (state >> 16) % (sizeof...(Kinds) - 1);
+        ((kind == Kinds ? (void)result.emplace_back(in_place_index<Kinds>, i, state) : void()), ...);
+    }
+    return result;
+}
+
+template <typename Event>
+std::vector<Event> make_events() {
+    return make_events<Event>(std::make_index_sequence<variant_size_v<Event>>());
+}
+
+struct price_sum {
+    template <typename Message>
+    uint64_t operator()(Message const& m) const {
+        return m.price + m.id;
+    }
+};
+
+template <typename Event, typename Visit>
+double run_visit(bench::runner& runner, char const* name, std::vector<Event> const& events, Visit visit_one) {
+    return runner.run(name, count, [&events, &visit_one] {
+        uint64_t sum = 0;
+        for (Event const& e : events) {
+            sum += visit_one(e);
+        }
+        bench::do_not_optimize(sum);
+    });
+}
+
+template <typename Event>
+double run_copy(bench::runner& runner, char const* name, std::vector<Event> const& events) {
+    std::vector<Event> targets = events;
+    return runner.run(name, count, [&events, &targets] {
+        for (size_t i = 0; i < count; ++i) {
+            targets[i] = events[count - 1 - i];
+        }
+        bench::do_not_optimize(targets);
+    });
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    bench::runner runner(argc > 1 ? argv[1] : "");
+    auto const uniform = make_events<uniform_event>();
+    auto const hinted = make_events<hinted_event>();
+
+    double visit_uniform = run_visit(runner, "visit/uniform", uniform, [](auto const& e) { return visit(price_sum(), e); });
+    double visit_likely_0 =
+        run_visit(runner, "visit/visit_likely<0>", uniform, [](auto const& e) { return visit_likely<0>(price_sum(), e); });
+    double visit_trait = run_visit(runner, "visit/hot_alternatives", hinted, [](auto const& e) { return visit(price_sum(), e); });
+    double copy_uniform = run_copy(runner, "copy_assign/uniform", uniform);
+    double copy_trait = run_copy(runner, "copy_assign/hot_alternatives", hinted);
+
+    std::printf("%-32s %12s\n", "case (90% alternative 0)", "ns/op");
+    std::printf("%-32s %12.2f\n", "visit", visit_uniform);
+    std::printf("%-32s %12.2f\n", "visit_likely<0>", visit_likely_0);
+    std::printf("%-32s %12.2f\n", "visit, hot_alternatives<0>", visit_trait);
+    std::printf("%-32s %12.2f\n", "copy assign", copy_uniform);
+    std::printf("%-32s %12.2f\n", "copy assign, hot_alternatives<0>", copy_trait);
+}
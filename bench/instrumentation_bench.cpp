@@ -0,0 +1,86 @@
+#include "../variant.h"
+#include "harness.h"
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+using value = variant<int64_t, double, std::string>;
+
+constexpr size_t count = 4096;
+
+std::vector<value> make_values() {
+    std::vector<value> result;
+    result.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        switch (i % 8) {
+        case 0:
+            result.emplace_back(in_place_index<2>, "a string that does not fit into sso");
+            break;
+        case 1:
+        case 2:
+            result.emplace_back(in_place_index<1>, double(i));
+            break;
+        default:
+            result.emplace_back(in_place_index<0>, int64_t(i));
+        }
+    }
+    return result;
+}
+
+struct weight {
+    size_t operator()(int64_t x) const {
+        return size_t(x);
+    }
+
+    size_t operator()(double x) const {
+        return size_t(x * 2);
+    }
+
+    size_t operator()(std::string const& s) const {
+        return s.size();
+    }
+};
+
+} // namespace
+
+int main(int argc, char** argv) {
+    bench::runner runner(argc > 1 ? argv[1] : "");
+    std::vector<value> const values = make_values();
+
+    double visit_ns = runner.run("visit", count, [&values] {
+        size_t sum = 0;
+        for (value const& v : values) {
+            sum += visit(weight(), v);
+        }
+        bench::do_not_optimize(sum);
+    });
+
+    std::vector<value> targets = values;
+    double assign_ns = runner.run("copy_assign", count, [&values, &targets] {
+        for (size_t i = 0; i < count; ++i) {
+            targets[i] = values[(i * 7) % count];
+        }
+        bench::do_not_optimize(targets);
+    });
+
+    double emplace_ns = runner.run("emplace", count, [&targets] {
+        for (size_t i = 0; i < count; ++i) {
+            targets[i].emplace<0>(int64_t(i));
+        }
+        bench::do_not_optimize(targets);
+    });
+
+#ifdef VARIANT_INSTRUMENTATION
+    char const* mode = "instrumented";
+#else
+    char const* mode = "disabled";
+#endif
+    std::printf("%-14s %12s %12s %12s\n", "mode", "visit ns", "assign ns", "emplace ns");
+    std::printf("%-14s %12.2f %12.2f %12.2f\n", mode, visit_ns, assign_ns, emplace_ns);
+#ifdef VARIANT_INSTRUMENTATION
+    dump_counters_text(std::cout, snapshot_counters());
+#endif
+}
@@ -0,0 +1,93 @@
+#include "../variant_parallel.h"
+#include "harness.h"
+#include <cmath>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using value = variant<int64_t, double, float>;
+
+std::vector<value> make_values(size_t count) {
+    std::vector<value> result;
+    result.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        switch (i % 3) {
+        case 0:
+            result.emplace_back(in_place_index<0>, int64_t(i));
+            break;
+        case 1:
+            result.emplace_back(in_place_index<1>, double(i) * 0.25);
+            break;
+        default:
+            result.emplace_back(in_place_index<2>, float(i));
+        }
+    }
+    return result;
+}
+
+struct score {
+    double operator()(int64_t x) const {
+        return double(x % 97) * 1.5;
+    }
+
+    double operator()(double x) const {
+        return std::sqrt(x);
+    }
+
+    double operator()(float x) const {
+        return double(x) * 0.5;
+    }
+};
+
+void transform_slice(std::vector<value> const& values, std::vector<double>& out, size_t first, size_t last) {
+    value const* data = values.data() + first;
+    variant_utils::for_each_grouped(data, last - first, [data, &out, first](auto alternative, size_t i) {
+        out[first + i] = score()(variant_utils::variant_access::get<alternative>(data[i]));
+    });
+}
+
+void spawn_per_call(std::vector<value> const& values, std::vector<double>& out, size_t threads) {
+    std::vector<std::thread> workers;
+    size_t count = values.size();
+    for (size_t t = 1; t < threads; ++t) {
+        workers.emplace_back([&values, &out, count, threads, t] {
+            transform_slice(values, out, count * t / threads, count * (t + 1) / threads);
+        });
+    }
+    transform_slice(values, out, 0, count / threads);
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    bench::runner runner(argc > 1 ? argv[1] : "");
+    size_t hardware = std::max(4u, std::thread::hardware_concurrency());
+    std::printf("%u hardware threads\n", std::thread::hardware_concurrency());
+    std::printf("%-10s %-8s %14s %14s %10s\n", "elements", "threads", "pool ns/elem", "spawn ns/elem", "speedup");
+    for (size_t count : { size_t(1) << 12, size_t(1) << 16, size_t(1) << 20 }) {
+        std::vector<value> const values = make_values(count);
+        std::vector<double> out(count);
+        double single = 0;
+        for (size_t threads = 1; threads <= hardware; threads *= 2) {
+            parallel_options options{ threads, std::max<size_t>(count / (threads * 4), 1024), 0 };
+            std::string suffix = "/" + std::to_string(count) + "/" + std::to_string(threads);
+            double pool = runner.run("pool" + suffix, count, [&values, &out, &options] {
+                parallel_transform(values, out.begin(), score(), options);
+                bench::do_not_optimize(out);
+            });
+            double spawn = runner.run("spawn" + suffix, count, [&values, &out, threads] {
+                spawn_per_call(values, out, threads);
+                bench::do_not_optimize(out);
+            });
+            if (threads == 1) {
+                single = pool;
+            }
+            std::printf("%-10zu %-8zu %14.2f %14.2f %10.2f\n", count, threads, pool, spawn, single / pool);
+        }
+    }
+}
@@ -0,0 +1,132 @@
+#include "../variant_relocation.h"
+#include "harness.h"
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+template <>
+struct is_trivially_relocatable<std::vector<int>> : std::true_type {};
+
+template <>
+struct is_trivially_relocatable<std::unique_ptr<int>> : std::true_type {};
+
+namespace {
+
+using V = variant<std::vector<int>, std::unique_ptr<int>, int>;
+
+static_assert(is_trivially_relocatable_v<V>);
+
+constexpr size_t count = 4096;
+
+class relocating_buffer {
+public:
+    relocating_buffer() = default;
+    relocating_buffer(relocating_buffer const&) = delete;
+
+    ~relocating_buffer() {
+        std::destroy(data, data + size);
+        std::free(data);
+    }
+
+    template <typename... Args>
+    void emplace_back(Args&&... args) {
+        if (size == capacity) {
+            capacity = capacity ? capacity * 2 : 1;
+            V* grown = static_cast<V*>(std::malloc(capacity * sizeof(V)));
+            uninitialized_relocate(data, data + size, grown);
+            std::free(data);
+            data = grown;
+        }
+        std::construct_at(data + size, std::forward<Args>(args)...);
+        ++size;
+    }
+
+    void erase(size_t position) {
+        std::destroy_at(data + position);
+        uninitialized_relocate(data + position + 1, data + size, data + position);
+        --size;
+    }
+
+    V* data = nullptr;
+    size_t size = 0;
+    size_t capacity = 0;
+};
+
+V make(size_t i) {
+    switch (i % 3) {
+    case 0:
+        return V(in_place_index<0>, 4, int(i));
+    case 1:
+        return V(in_place_index<1>, std::make_unique<int>(int(i)));
+    default:
+        return V(in_place_index<2>, int(i));
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    bench::runner runner(argc > 1 ? argv[1] : "");
+    std::vector<V> const source = [] {
+        std::vector<V> result;
+        for (size_t i = 0; i < count; ++i) {
+            result.push_back(make(i));
+        }
+        return result;
+    }();
+    auto copy_of = [&source](size_t i) -> V {
+        return visit([](auto const& value) -> V {
+            using T = std::decay_t<decltype(value)>;
+            if constexpr (std::is_same_v<T, std::unique_ptr<int>>) {
+                return V(std::make_unique<int>(*value));
+            }
+            else {
+                return V(value);
+            }
+        }, source[i]);
+    };
+
+    double move_growth = runner.run("growth/move", count, [&copy_of] {
+        std::vector<V> v;
+        for (size_t i = 0; i < count; ++i) {
+            v.push_back(copy_of(i));
+        }
+        bench::do_not_optimize(v);
+    });
+    double relocate_growth = runner.run("growth/relocate", count, [&copy_of] {
+        relocating_buffer v;
+        for (size_t i = 0; i < count; ++i) {
+            v.emplace_back(copy_of(i));
+        }
+        bench::do_not_optimize(v);
+    });
+
+    constexpr size_t erases = count / 4;
+    double move_erase = runner.run("erase_middle/move", erases, [&copy_of] {
+        std::vector<V> v;
+        v.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            v.push_back(copy_of(i));
+        }
+        for (size_t i = 0; i < erases; ++i) {
+            v.erase(v.begin() + v.size() / 2);
+        }
+        bench::do_not_optimize(v);
+    });
+    double relocate_erase = runner.run("erase_middle/relocate", erases, [&copy_of] {
+        relocating_buffer v;
+        for (size_t i = 0; i < count; ++i) {
+            v.emplace_back(copy_of(i));
+        }
+        for (size_t i = 0; i < erases; ++i) {
+            v.erase(v.size / 2);
+        }
+        bench::do_not_optimize(v);
+    });
+
+    std::printf("%-24s %12s %12s %8s\n", "case", "move", "relocate", "ratio");
+    std::printf("%-24s %12.2f %12.2f %8.2f\n", "growth", move_growth, relocate_growth, relocate_growth / move_growth);
+    std::printf("%-24s %12.2f %12.2f %8.2f\n", "erase_middle", move_erase, relocate_erase, relocate_erase / move_erase);
+}
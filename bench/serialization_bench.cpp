@@ -0,0 +1,275 @@
+#include "../variant_serialization.h"
+#include "harness.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct point {
+    int x;
+    int y;
+    double weight;
+
+    friend bool operator==(point const&, point const&) = default;
+};
+
+using V = variant<int, double, point, std::string, std::vector<int>>;
+using view_type = variant_array_view<int, double, point, std::string, std::vector<int>>;
+
+constexpr size_t count = 1 << 16;
+
+std::vector<V> make_values() {
+    std::vector<V> result;
+    uint32_t state = 12345;
+    for (size_t i = 0; i < count; ++i) {
+        state = state * 1664525u + 1013904223u;
+        switch ((state >> 8) % 5) {
+        case 0:
+            result.emplace_back(int(state));
+            break;
+        case 1:
+            result.emplace_back(double(state) / 7);
+            break;
+        case 2:
+            result.emplace_back(point{ int(i), int(state), 0.5 });
+            break;
+        case 3:
+            result.emplace_back(std::string((state >> 16) % 48, 'x'));
+            break;
+        default:
+            result.emplace_back(std::vector<int>((state >> 16) % 16, int(i)));
+        }
+    }
+    return result;
+}
+
+size_t checksum(V const& v) {
+    return visit(
+        [](auto const& value) -> size_t {
+            using T = std::decay_t<decltype(value)>;
+            if constexpr (std::is_same_v<T, point>) {
+                return value.x + value.y;
+            }
+            else if constexpr (std::is_arithmetic_v<T>) {
+                return size_t(value);
+            }
+            else {
+                return value.size();
+            }
+        },
+        v);
+}
+
+size_t view_checksum(view_type const& view, size_t i) {
+    return view.visit(i, [](auto const& value) -> size_t {
+        using T = std::decay_t<decltype(value)>;
+        if constexpr (std::is_same_v<T, point>) {
+            return value.x + value.y;
+        }
+        else if constexpr (std::is_arithmetic_v<T>) {
+            return size_t(value);
+        }
+        else {
+            return value.size();
+        }
+    });
+}
+
+void check_stream(std::vector<V> const& values) {
+    std::vector<std::byte> stream;
+    for (V const& v : values) {
+        size_t offset = stream.size();
+        stream.resize(offset + serialized_size(v));
+        bench::require(serialize(v, stream.data() + offset) == stream.data() + stream.size(),
+                       "serialize wrote a wrong size");
+    }
+    std::span<std::byte const> in(stream);
+    V v;
+    for (V const& expected : values) {
+        std::byte const* next = deserialize(in, v);
+        bench::require(v == expected, "stream round trip mismatch");
+        in = in.subspan(next - in.data());
+    }
+    bench::require(in.empty(), "stream has trailing bytes");
+}
+
+void check_array(std::vector<V> const& values) {
+    std::vector<std::byte> array = serialize_array(values);
+    view_type view(array);
+    bench::require(view.size() == values.size(), "array size mismatch");
+    std::vector<int> ints;
+    for (size_t i = 0; i < values.size(); ++i) {
+        bench::require(view.index(i) == values[i].index(), "array index mismatch");
+        bench::require(view.load(i) == values[i], "array round trip mismatch");
+        if (values[i].index() == 0) {
+            ints.push_back(get<0>(values[i]));
+        }
+        if (values[i].index() == 3) {
+            bench::require(view.get<3>(i) == get<3>(values[i]), "string view mismatch");
+        }
+        if (values[i].index() == 4) {
+            std::span<int const> elements = view.get<4>(i);
+            std::vector<int> const& expected = get<4>(values[i]);
+            bench::require(std::equal(elements.begin(), elements.end(), expected.begin(), expected.end()),
+                           "vector view mismatch");
+        }
+    }
+    std::span<int const> column = view.alternative<0>();
+    bench::require(std::equal(column.begin(), column.end(), ints.begin(), ints.end()), "int column mismatch");
+}
+
+#if VARIANT_EXCEPTIONS
+template <typename Body>
+void require_rejected(Body body, char const* what) {
+    try {
+        body();
+    } catch (std::invalid_argument const&) {
+        return;
+    } catch (std::out_of_range const&) {
+        return;
+    }
+    bench::require(false, what);
+}
+
+void check_rejections(std::vector<V> const& values) {
+    V v;
+    std::vector<std::byte> stream(serialized_size(values[0]));
+    serialize(values[0], stream.data());
+
+    std::byte bad_tag[] = { std::byte{ 5 } };
+    require_rejected([&bad_tag, &v] { deserialize(std::span<std::byte const>(bad_tag), v); }, "invalid tag accepted");
+    std::span<std::byte const> first(stream.data(), stream.size() - 1);
+    require_rejected([first, &v] { deserialize(first, v); }, "truncated payload accepted");
+
+    std::vector<std::byte> partial(1 + sizeof(variant_utils::length_type) + 7);
+    partial[0] = std::byte{ 4 };
+    variant_utils::length_type length = 7;
+    std::memcpy(partial.data() + 1, &length, sizeof(length));
+    require_rejected([&partial, &v] { deserialize(std::span<std::byte const>(partial), v); },
+                     "partial vector element accepted");
+    require_rejected(
+        [&partial, &v] {
+            variant_decoder<int, double, point, std::string, std::vector<int>> decoder;
+            decoder.feed(partial, v);
+        },
+        "partial vector element accepted by the decoder");
+
+    std::vector<std::byte> array = serialize_array(values);
+    auto corrupted = [&array](size_t offset, uint64_t value) {
+        std::vector<std::byte> copy = array;
+        std::memcpy(copy.data() + offset, &value, sizeof(value));
+        return copy;
+    };
+    using header = variant_utils::array_header;
+    using column_header = variant_utils::column_header;
+    header original;
+    std::memcpy(&original, array.data(), sizeof(original));
+    size_t int_column = sizeof(header);
+    size_t string_column = sizeof(header) + 3 * sizeof(column_header);
+    std::vector<std::vector<std::byte>> malformed = {
+        corrupted(offsetof(header, count), uint64_t(1) << 62),
+        corrupted(offsetof(header, count), ~uint64_t(0)),
+        corrupted(offsetof(header, slots_offset), original.slots_offset + 1),
+        corrupted(offsetof(header, tags_offset), array.size() + 64),
+        corrupted(int_column + offsetof(column_header, count), uint64_t(1) << 62),
+        corrupted(int_column + offsetof(column_header, offset), array.size() - 4 + 1),
+        corrupted(string_column + offsetof(column_header, count), uint64_t(1) << 60),
+        corrupted(string_column + offsetof(column_header, offset), original.slots_offset + 4),
+        corrupted(0, 0),
+        std::vector<std::byte>(array.begin(), array.begin() + sizeof(header)),
+    };
+    for (std::vector<std::byte> const& bytes : malformed) {
+        require_rejected([&bytes] { view_type{ bytes }; }, "malformed array header accepted");
+    }
+}
+#endif
+
+} // namespace
+
+int main(int argc, char** argv) {
+    bench::runner runner(argc > 1 ? argv[1] : "");
+    std::vector<V> const values = make_values();
+    check_stream(values);
+    check_array(values);
+#if VARIANT_EXCEPTIONS
+    check_rejections(values);
+#endif
+    size_t expected = 0;
+    size_t stream_bytes = 0;
+    for (V const& v : values) {
+        expected += checksum(v);
+        stream_bytes += serialized_size(v);
+    }
+
+    std::vector<std::byte> stream(stream_bytes);
+    double encode = runner.run("stream/serialize", count, [&values, &stream] {
+        std::byte* out = stream.data();
+        for (V const& v : values) {
+            out = serialize(v, out);
+        }
+        bench::do_not_optimize(stream);
+    });
+    double decode = runner.run("stream/deserialize", count, [&stream] {
+        std::span<std::byte const> in(stream);
+        V v;
+        size_t sum = 0;
+        while (!in.empty()) {
+            std::byte const* next = deserialize(in, v);
+            in = in.subspan(next - in.data());
+            sum += checksum(v);
+        }
+        bench::do_not_optimize(sum);
+    });
+    double decode_chunks = runner.run("stream/decoder_64b_chunks", count, [&stream] {
+        variant_decoder<int, double, point, std::string, std::vector<int>> decoder;
+        V v;
+        size_t sum = 0;
+        for (size_t offset = 0; offset < stream.size(); offset += 64) {
+            std::span<std::byte const> in(stream.data() + offset, std::min<size_t>(64, stream.size() - offset));
+            while (!in.empty()) {
+                auto [status, consumed] = decoder.feed(in, v);
+                in = in.subspan(consumed);
+                if (status == decode_status::complete) {
+                    sum += checksum(v);
+                }
+            }
+        }
+        bench::do_not_optimize(sum);
+    });
+
+    std::string const path = "variant_serialization_bench.bin";
+    std::vector<std::byte> array = serialize_array(values);
+    double array_encode = runner.run("array/serialize", count, [&values, &array] {
+        array = serialize_array(values);
+        bench::do_not_optimize(array);
+    });
+    {
+        std::ofstream file(path, std::ios::binary);
+        file.write(reinterpret_cast<char const*>(array.data()), std::streamsize(array.size()));
+    }
+    std::vector<std::byte> loaded(array.size());
+    double array_read = runner.run("array/read_file_and_visit", count, [&path, &loaded, expected] {
+        std::ifstream file(path, std::ios::binary);
+        file.read(reinterpret_cast<char*>(loaded.data()), std::streamsize(loaded.size()));
+        view_type view(loaded);
+        size_t sum = 0;
+        for (size_t i = 0; i < view.size(); ++i) {
+            sum += view_checksum(view, i);
+        }
+        bench::require(sum == expected, "array round trip mismatch");
+    });
+    std::remove(path.c_str());
+
+    auto mb_per_s = [](double ns_per_op, size_t bytes) { return double(bytes) / (ns_per_op * count) * 1e3; };
+    std::printf("%-28s %12s %12s\n", "case", "ns/variant", "MB/s");
+    std::printf("%-28s %12.2f %12.1f\n", "stream/serialize", encode, mb_per_s(encode, stream_bytes));
+    std::printf("%-28s %12.2f %12.1f\n", "stream/deserialize", decode, mb_per_s(decode, stream_bytes));
+    std::printf("%-28s %12.2f %12.1f\n", "stream/decoder_64b_chunks", decode_chunks,
+                mb_per_s(decode_chunks, stream_bytes));
+    std::printf("%-28s %12.2f %12.1f\n", "array/serialize", array_encode, mb_per_s(array_encode, array.size()));
+    std::printf("%-28s %12.2f %12.1f\n", "array/read_file_and_visit", array_read, mb_per_s(array_read, array.size()));
+}
@@ -0,0 +1,98 @@
+#include "variant.h"
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <string_view>
+#include <utility>
+
+#ifndef STARTUP_CONSTINIT
+#define STARTUP_CONSTINIT
+#endif
+
+#ifndef UNITS
+#define UNITS 200
+#endif
+
+template <int Unit>
+int unit_checksum();
+
+#ifdef UNIT
+
+namespace {
+
+struct route {
+    std::string_view path;
+    int handler;
+
+    constexpr route(std::string_view path, int handler) : path(path), handler(handler) {}
+    constexpr route(route const& other) : path(other.path), handler(other.handler) {}
+    constexpr route& operator=(route const& other) {
+        path = other.path;
+        handler = other.handler;
+        return *this;
+    }
+    constexpr ~route() {}
+};
+
+using entry = variant<int, double, std::string_view, route>;
+
+constexpr size_t table_size = 256;
+
+template <int Unit>
+constexpr std::array<entry, table_size> make_table() {
+    std::array<entry, table_size> table{};
+    for (size_t i = 0; i < table_size; ++i) {
+        switch (i % 4) {
+        case 0:
+            table[i] = int(i) + Unit;
+            break;
+        case 1:
+            table[i].template emplace<1>(double(i) / 2);
+            break;
+        case 2:
+            table[i].template emplace<std::string_view>("/api/v1/default");
+            break;
+        default:
+            table[i] = route("/api/v1/orders", Unit);
+        }
+    }
+    for (size_t i = 0; i + 1 < table_size; i += 2) {
+        swap(table[i], table[i + 1]);
+    }
+    table[3] = table[4];
+    return table;
+}
+
+STARTUP_CONSTINIT std::array<entry, table_size> const table = make_table<UNIT>();
+
+} // namespace
+
+template <>
+int unit_checksum<UNIT>() {
+    return get<0>(table[1]) + int(table[table_size - 1].index());
+}
+
+#else
+
+namespace {
+
+std::chrono::steady_clock::time_point start;
+
+__attribute__((constructor(101))) void mark_start() {
+    start = std::chrono::steady_clock::now();
+}
+
+} // namespace
+
+template <int... Units>
+int checksum(std::integer_sequence<int, Units...>) {
+    return (unit_checksum<Units>() + ...);
+}
+
+int main() {
+    std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+    int sum = checksum(std::make_integer_sequence<int, UNITS>());
+    std::printf("%.1f %d\n", elapsed.count(), sum);
+}
+
+#endif
@@ -0,0 +1,32 @@
+#!/bin/sh
+# Time from the first static initializer to main() for UNITS translation units, each holding a
+# 256-entry variant table built with emplace, assignment and swap. BASELINE may point to an older
+# checkout whose tables can only be initialized dynamically.
+CXX=${CXX:-g++}
+UNITS=${UNITS:-200}
+RUNS=${RUNS:-21}
+cd "$(dirname "$0")"
+out=$(mktemp -d)
+trap 'rm -rf "$out"' EXIT
+
+build() {
+    for unit in $(seq 0 $((UNITS - 1))); do
+        $CXX -std=c++20 -O2 -I"$1" -DUNITS="$UNITS" -DUNIT="$unit" -DSTARTUP_CONSTINIT="$2" -c startup_bench.cpp \
+            -o "$out/unit$unit.o" &
+        [ $((unit % 8)) -eq 7 ] && wait
+    done
+    wait
+    $CXX -std=c++20 -O2 -I"$1" -DUNITS="$UNITS" startup_bench.cpp "$out"/unit*.o -o "$out/$3"
+}
+
+measure() {
+    printf '%-10s median us to main: ' "$1"
+    for run in $(seq "$RUNS"); do "$out/$1" | cut -d' ' -f1; done | sort -n | sed -n "$(((RUNS + 1) / 2))p"
+}
+
+build .. constinit constinit
+measure constinit
+if [ -n "$BASELINE" ]; then
+    build "$BASELINE" "" baseline
+    measure baseline
+fi
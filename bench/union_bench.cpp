@@ -0,0 +1,33 @@
+#include "variant.h"
+#include <utility>
+
+#ifndef ALTERNATIVES
+#define ALTERNATIVES 8
+#endif
+
+template <size_t Tag>
+struct alternative {
+    int value;
+};
+
+template <typename Indexes>
+struct make_variant;
+
+template <size_t... Indexes>
+struct make_variant<std::index_sequence<Indexes...>> {
+    using type = variant<alternative<Indexes>...>;
+};
+
+using V = make_variant<std::make_index_sequence<ALTERNATIVES>>::type;
+
+template <size_t... Indexes>
+int touch(V& v, std::index_sequence<Indexes...>) {
+    int sum = 0;
+    ((v.template emplace<Indexes>(alternative<Indexes>{ int(Indexes) }), sum += get<Indexes>(v).value), ...);
+    return sum;
+}
+
+int main() {
+    V v;
+    return touch(v, std::make_index_sequence<ALTERNATIVES>()) == 0 ? 0 : 1;
+}
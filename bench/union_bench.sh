@@ -0,0 +1,19 @@
+#!/bin/sh
+# Frontend time of bench/union_bench.cpp, which emplaces and reads every alternative, for a sweep of
+# alternative counts. BASELINE may point to an older checkout that stores alternatives in a recursive union.
+CXX=${CXX:-g++}
+cd "$(dirname "$0")"
+
+measure() {
+    $CXX -std=c++20 -fsyntax-only -ftime-report -ftemplate-depth=4096 -I"$1" -DALTERNATIVES="$2" union_bench.cpp 2>&1 |
+        awk '$1 == "TOTAL" { print $5 }'
+}
+
+printf '%-14s %10s' alternatives tree
+[ -n "$BASELINE" ] && printf ' %10s' recursive
+echo
+for n in ${ALTERNATIVES:-8 32 128 256}; do
+    printf '%-14s %9ss' "$n" "$(measure .. "$n")"
+    [ -n "$BASELINE" ] && printf ' %9ss' "$(measure "$BASELINE" "$n")"
+    echo
+done
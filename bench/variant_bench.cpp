@@ -0,0 +1,516 @@
+#include "../variant.h"
+#include "harness.h"
+#include <algorithm>
+#include <array>
+#include <compare>
+#include <cstdio>
+#include <map>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#if __has_include(<boost/variant2/variant.hpp>)
+#include <boost/variant2/variant.hpp>
+#define VARIANT_BENCH_BOOST 1
+#endif
+
+namespace {
+
+template <size_t Size, size_t Tag>
+struct payload {
+    std::array<unsigned char, Size> bytes{};
+
+    payload() = default;
+
+    explicit payload(size_t seed) {
+        bytes.fill(static_cast<unsigned char>(seed));
+    }
+
+    unsigned char first() const {
+        return bytes[0];
+    }
+
+    friend auto operator<=>(payload const&, payload const&) = default;
+};
+
+struct ours {
+    static constexpr char const* name = "variant";
+
+    template <typename... Types>
+    using variant_type = variant<Types...>;
+
+    template <size_t Index>
+    static constexpr auto in_place = in_place_index<Index>;
+
+    template <size_t Index, typename Variant>
+    static decltype(auto) get(Variant&& v) {
+        return ::get<Index>(std::forward<Variant>(v));
+    }
+
+    template <size_t Index, typename Variant>
+    static auto get_if(Variant* v) {
+        return ::get_if<Index>(v);
+    }
+
+    template <typename Visitor, typename... Variants>
+    static decltype(auto) visit(Visitor&& vis, Variants&&... vars) {
+        return ::visit(std::forward<Visitor>(vis), std::forward<Variants>(vars)...);
+    }
+};
+
+struct standard {
+    static constexpr char const* name = "std::variant";
+
+    template <typename... Types>
+    using variant_type = std::variant<Types...>;
+
+    template <size_t Index>
+    static constexpr auto in_place = std::in_place_index<Index>;
+
+    template <size_t Index, typename Variant>
+    static decltype(auto) get(Variant&& v) {
+        return std::get<Index>(std::forward<Variant>(v));
+    }
+
+    template <size_t Index, typename Variant>
+    static auto get_if(Variant* v) {
+        return std::get_if<Index>(v);
+    }
+
+    template <typename Visitor, typename... Variants>
+    static decltype(auto) visit(Visitor&& vis, Variants&&... vars) {
+        return std::visit(std::forward<Visitor>(vis), std::forward<Variants>(vars)...);
+    }
+};
+
+#ifdef VARIANT_BENCH_BOOST
+struct boost_variant2 {
+    static constexpr char const* name = "boost::variant2";
+
+    template <typename... Types>
+    using variant_type = boost::variant2::variant<Types...>;
+
+    template <size_t Index>
+    static constexpr auto in_place = boost::variant2::in_place_index<Index>;
+
+    template <size_t Index, typename Variant>
+    static decltype(auto) get(Variant&& v) {
+        return boost::variant2::get<Index>(std::forward<Variant>(v));
+    }
+
+    template <size_t Index, typename Variant>
+    static auto get_if(Variant* v) {
+        return boost::variant2::get_if<Index>(v);
+    }
+
+    template <typename Visitor, typename... Variants>
+    static decltype(auto) visit(Visitor&& vis, Variants&&... vars) {
+        return boost::variant2::visit(std::forward<Visitor>(vis), std::forward<Variants>(vars)...);
+    }
+};
+#endif
+
+template <typename Lib, size_t Size, typename Indexes>
+struct make_variant;
+
+template <typename Lib, size_t Size, size_t... Indexes>
+struct make_variant<Lib, Size, std::index_sequence<Indexes...>> {
+    using type = typename Lib::template variant_type<payload<Size, Indexes>...>;
+};
+
+constexpr size_t batch = 256;
+
+#ifdef VARIANT_BENCH_ONLY
+constexpr std::string_view only_case = VARIANT_BENCH_ONLY;
+#else
+constexpr std::string_view only_case;
+#endif
+
+#ifdef VARIANT_BENCH_LIBRARY
+constexpr std::string_view only_library = VARIANT_BENCH_LIBRARY;
+#else
+constexpr std::string_view only_library;
+#endif
+
+constexpr bool selected(std::string_view what) {
+    return only_case.empty() || only_case == what;
+}
+
+constexpr bool selected_library(std::string_view name) {
+    return only_library.empty() || only_library == name;
+}
+
+#ifdef VARIANT_BENCH_EMPTY
+#define VARIANT_BENCH_CASE(what, ops, ...)                                                                             \
+    if constexpr (selected(what))                                                                                      \
+    measure(runner, what, ops, [] {})
+#else
+#define VARIANT_BENCH_CASE(what, ...)                                                                                  \
+    if constexpr (selected(what))                                                                                      \
+    measure(runner, what, __VA_ARGS__)
+#endif
+
+struct row {
+    std::string key;
+    std::map<std::string, double> ns;
+    size_t ours_size = 0;
+    size_t std_size = 0;
+};
+
+std::vector<row> rows;
+
+void record(std::string const& key, char const* lib, double ns, size_t size) {
+    auto it = std::find_if(rows.begin(), rows.end(), [&key](row const& r) { return r.key == key; });
+    if (it == rows.end()) {
+        rows.push_back({ key, {}, 0, 0 });
+        it = rows.end() - 1;
+    }
+    it->ns[lib] = ns;
+    if (std::string(lib) == ours::name) {
+        it->ours_size = size;
+    }
+    if (std::string(lib) == standard::name) {
+        it->std_size = size;
+    }
+}
+
+template <typename Lib, size_t Count, size_t Size>
+struct suite {
+    using V = typename make_variant<Lib, Size, std::make_index_sequence<Count>>::type;
+
+    template <size_t... Indexes>
+    static V make(size_t index, size_t seed, std::index_sequence<Indexes...>) {
+        V result(Lib::template in_place<0>, payload<Size, 0>(seed));
+        ((index == Indexes ? (void)(result = V(Lib::template in_place<Indexes>, payload<Size, Indexes>(seed))) : void()),
+         ...);
+        return result;
+    }
+
+    static std::vector<V> inputs(size_t shift) {
+        std::vector<V> result;
+        uint32_t state = 12345;
+        for (size_t i = 0; i < batch; ++i) {
+            state = state * 1664525u + 1013904223u;
+            result.push_back(make((state >> 8) % Count + shift, state >> 16, std::make_index_sequence<Count>()));
+        }
+        return result;
+    }
+
+    static std::vector<V> shifted(std::vector<V> const& source) {
+        std::vector<V> result;
+        for (V const& v : source) {
+            result.push_back(make((v.index() + 1) % Count, 7, std::make_index_sequence<Count>()));
+        }
+        return result;
+    }
+
+    static void measure(bench::runner& runner, std::string const& what, size_t ops, auto&& body) {
+        std::string key = what + "/alts=" + std::to_string(Count) + "/payload=" + std::to_string(Size);
+        if (!runner.enabled(key)) {
+            return;
+        }
+        record(key, Lib::name, runner.run(key + "/" + Lib::name, ops, body), sizeof(V));
+    }
+
+    static void run(bench::runner& runner) {
+        std::vector<V> const source = inputs(0);
+        std::vector<V> const other = shifted(source);
+        std::vector<V> targets = source;
+        std::vector<V> cross = other;
+
+        VARIANT_BENCH_CASE("construct", batch, [] {
+            for (size_t i = 0; i < batch; ++i) {
+                V v(Lib::template in_place<Count - 1>, payload<Size, Count - 1>(i));
+                bench::do_not_optimize(v);
+            }
+        });
+        VARIANT_BENCH_CASE("copy_ctor", batch, [&source] {
+            for (V const& v : source) {
+                V copy(v);
+                bench::do_not_optimize(copy);
+            }
+        });
+        VARIANT_BENCH_CASE("move_ctor", batch, [&targets] {
+            for (V& v : targets) {
+                V moved(std::move(v));
+                bench::do_not_optimize(moved);
+            }
+        });
+        VARIANT_BENCH_CASE("copy_assign_same", batch, [&source, &targets] {
+            for (size_t i = 0; i < batch; ++i) {
+                targets[i] = source[i];
+            }
+            bench::do_not_optimize(targets);
+        });
+        VARIANT_BENCH_CASE("copy_assign_cross", batch, [&source, &other, &cross] {
+            for (size_t i = 0; i < batch; ++i) {
+                cross[i] = source[i];
+                cross[i] = other[i];
+            }
+            bench::do_not_optimize(cross);
+        });
+        VARIANT_BENCH_CASE("move_assign_same", batch, [&source, &targets] {
+            for (size_t i = 0; i < batch; ++i) {
+                V tmp(source[i]);
+                targets[i] = std::move(tmp);
+            }
+            bench::do_not_optimize(targets);
+        });
+        VARIANT_BENCH_CASE("move_assign_cross", batch, [&other, &cross] {
+            for (size_t i = 0; i < batch; ++i) {
+                V tmp(other[(i + 1) % batch]);
+                cross[i] = std::move(tmp);
+            }
+            bench::do_not_optimize(cross);
+        });
+        VARIANT_BENCH_CASE("emplace", batch, [&targets] {
+            for (size_t i = 0; i < batch; ++i) {
+                targets[i].template emplace<Count - 1>(payload<Size, Count - 1>(i));
+            }
+            bench::do_not_optimize(targets);
+        });
+        targets = source;
+        cross = other;
+        VARIANT_BENCH_CASE("swap_same", batch, [&targets] {
+            for (size_t i = 0; i + 1 < batch; i += 2) {
+                using std::swap;
+                swap(targets[i], targets[i]);
+            }
+            bench::do_not_optimize(targets);
+        });
+        VARIANT_BENCH_CASE("swap_cross", batch, [&targets, &cross] {
+            for (size_t i = 0; i < batch; ++i) {
+                using std::swap;
+                swap(targets[i], cross[i]);
+            }
+            bench::do_not_optimize(targets);
+        });
+        VARIANT_BENCH_CASE("visit", batch, [&source] {
+            size_t sum = 0;
+            for (V const& v : source) {
+                sum += Lib::visit([](auto const& p) { return p.first(); }, v);
+            }
+            bench::do_not_optimize(sum);
+        });
+        VARIANT_BENCH_CASE("visit2", batch, [&source, &other] {
+            size_t sum = 0;
+            for (size_t i = 0; i < batch; ++i) {
+                sum += Lib::visit([](auto const& p, auto const& q) { return p.first() ^ q.first(); }, source[i], other[i]);
+            }
+            bench::do_not_optimize(sum);
+        });
+        if constexpr (Count <= 8) {
+            std::vector<V> const third = shifted(other);
+            VARIANT_BENCH_CASE("visit3", batch, [&source, &other, &third] {
+                size_t sum = 0;
+                for (size_t i = 0; i < batch; ++i) {
+                    sum += Lib::visit(
+                        [](auto const& p, auto const& q, auto const& r) { return p.first() ^ q.first() ^ r.first(); },
+                        source[i], other[i], third[i]);
+                }
+                bench::do_not_optimize(sum);
+            });
+        }
+        VARIANT_BENCH_CASE("eq", batch, [&source, &other] {
+            size_t sum = 0;
+            for (size_t i = 0; i < batch; ++i) {
+                sum += source[i] == other[(i * 7) % batch];
+            }
+            bench::do_not_optimize(sum);
+        });
+        VARIANT_BENCH_CASE("ne", batch, [&source, &other] {
+            size_t sum = 0;
+            for (size_t i = 0; i < batch; ++i) {
+                sum += source[i] != other[(i * 7) % batch];
+            }
+            bench::do_not_optimize(sum);
+        });
+        VARIANT_BENCH_CASE("lt", batch, [&source, &other] {
+            size_t sum = 0;
+            for (size_t i = 0; i < batch; ++i) {
+                sum += source[i] < other[(i * 7) % batch];
+            }
+            bench::do_not_optimize(sum);
+        });
+        VARIANT_BENCH_CASE("gt", batch, [&source, &other] {
+            size_t sum = 0;
+            for (size_t i = 0; i < batch; ++i) {
+                sum += source[i] > other[(i * 7) % batch];
+            }
+            bench::do_not_optimize(sum);
+        });
+        VARIANT_BENCH_CASE("le", batch, [&source, &other] {
+            size_t sum = 0;
+            for (size_t i = 0; i < batch; ++i) {
+                sum += source[i] <= other[(i * 7) % batch];
+            }
+            bench::do_not_optimize(sum);
+        });
+        VARIANT_BENCH_CASE("ge", batch, [&source, &other] {
+            size_t sum = 0;
+            for (size_t i = 0; i < batch; ++i) {
+                sum += source[i] >= other[(i * 7) % batch];
+            }
+            bench::do_not_optimize(sum);
+        });
+        VARIANT_BENCH_CASE("sort", batch, [&source] {
+            std::vector<V> sorted = source;
+            std::sort(sorted.begin(), sorted.end());
+            bench::do_not_optimize(sorted);
+        });
+        std::vector<V> sorted = source;
+        std::sort(sorted.begin(), sorted.end());
+        VARIANT_BENCH_CASE("lower_bound", batch, [&sorted, &other] {
+            size_t sum = 0;
+            for (V const& v : other) {
+                sum += std::lower_bound(sorted.begin(), sorted.end(), v) - sorted.begin();
+            }
+            bench::do_not_optimize(sum);
+        });
+        targets = source;
+        VARIANT_BENCH_CASE("get", batch, [&targets] {
+            size_t sum = 0;
+            for (V& v : targets) {
+                if (v.index() == 0) {
+                    sum += Lib::template get<0>(v).first();
+                }
+            }
+            bench::do_not_optimize(sum);
+        });
+        VARIANT_BENCH_CASE("get_if", batch, [&targets] {
+            size_t sum = 0;
+            for (V& v : targets) {
+                if (auto* p = Lib::template get_if<0>(&v)) {
+                    sum += p->first();
+                }
+            }
+            bench::do_not_optimize(sum);
+        });
+    }
+};
+
+template <typename V>
+[[gnu::noinline]] void swap_all(std::vector<V>& left, std::vector<V>& right) {
+    for (size_t i = 0; i < left.size(); ++i) {
+        using std::swap;
+        swap(left[i], right[i]);
+    }
+}
+
+template <typename Lib>
+void run_swap_nontrivial(bench::runner& runner) {
+    using V = typename Lib::template variant_type<std::string, std::vector<int>>;
+    std::string key = "swap_cross_nontrivial/alts=2";
+    if constexpr (!selected("swap_cross_nontrivial")) {
+        return;
+    }
+    if (!runner.enabled(key)) {
+        return;
+    }
+    std::vector<V> left;
+    std::vector<V> right;
+    for (size_t i = 0; i < batch; ++i) {
+        left.emplace_back(Lib::template in_place<0>, std::string(32, 'x'));
+        right.emplace_back(Lib::template in_place<1>, std::vector<int>(8, int(i)));
+    }
+    record(key, Lib::name, runner.run(key + "/" + Lib::name, batch, [&left, &right] {
+        swap_all(left, right);
+        bench::do_not_optimize(left);
+    }), sizeof(V));
+}
+
+struct dispatch_row {
+    size_t alternatives;
+    double switch_ns;
+    double table_ns;
+};
+
+std::vector<dispatch_row> dispatch_rows;
+
+template <size_t Count>
+void run_dispatch(bench::runner& runner) {
+    using V = typename make_variant<ours, 8, std::make_index_sequence<Count>>::type;
+    std::string key = "dispatch/alts=" + std::to_string(Count);
+    if constexpr (!selected("dispatch") || !selected_library(ours::name)) {
+        return;
+    }
+    if (!runner.enabled(key)) {
+        return;
+    }
+    std::vector<V> const source = suite<ours, Count, 8>::inputs(0);
+    auto vis = [](auto const& p) -> size_t { return p.first(); };
+    using table = variant_utils::visit_table<false, size_t, decltype(vis)&, std::make_index_sequence<Count>, V const&>;
+    double switch_ns = runner.run(key + "/switch", batch, [&source, &vis] {
+        size_t sum = 0;
+        for (V const& v : source) {
+            sum += variant_utils::visit_switch<false, size_t>(vis, v);
+        }
+        bench::do_not_optimize(sum);
+    });
+    double table_ns = runner.run(key + "/table", batch, [&source, &vis] {
+        size_t sum = 0;
+        for (V const& v : source) {
+            sum += table::value[v.index()](vis, v);
+        }
+        bench::do_not_optimize(sum);
+    });
+    dispatch_rows.push_back({ Count, switch_ns, table_ns });
+}
+
+template <typename Lib>
+void run_library(bench::runner& runner) {
+    if constexpr (selected_library(Lib::name)) {
+        suite<Lib, 2, 8>::run(runner);
+        suite<Lib, 2, 64>::run(runner);
+        suite<Lib, 8, 8>::run(runner);
+        suite<Lib, 8, 64>::run(runner);
+        suite<Lib, 32, 8>::run(runner);
+        suite<Lib, 32, 64>::run(runner);
+        run_swap_nontrivial<Lib>(runner);
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    bench::runner runner(argc > 1 ? argv[1] : "");
+    run_library<ours>(runner);
+    run_library<standard>(runner);
+#ifdef VARIANT_BENCH_BOOST
+    run_library<boost_variant2>(runner);
+#endif
+    run_dispatch<2>(runner);
+    run_dispatch<4>(runner);
+    run_dispatch<8>(runner);
+    run_dispatch<16>(runner);
+    run_dispatch<32>(runner);
+
+    std::printf("%-40s %12s %14s", "case", "variant", "std::variant");
+#ifdef VARIANT_BENCH_BOOST
+    std::printf(" %16s", "boost::variant2");
+#endif
+    std::printf(" %8s %14s\n", "ratio", "sizeof");
+    for (row const& r : rows) {
+        auto ns = [&r](char const* lib) {
+            auto it = r.ns.find(lib);
+            return it == r.ns.end() ? 0.0 : it->second;
+        };
+        double mine = ns(ours::name);
+        double baseline = ns(standard::name);
+        std::printf("%-40s %12.2f %14.2f", r.key.c_str(), mine, baseline);
+#ifdef VARIANT_BENCH_BOOST
+        std::printf(" %16.2f", ns(boost_variant2::name));
+#endif
+        std::printf(" %8.2f %7zu/%-6zu\n", mine / baseline, r.ours_size, r.std_size);
+    }
+
+    if (!dispatch_rows.empty()) {
+        std::printf("\n%-12s %12s %12s %8s\n", "dispatch", "switch", "table", "ratio");
+        for (dispatch_row const& r : dispatch_rows) {
+            std::printf("alts=%-7zu %12.2f %12.2f %8.2f\n", r.alternatives, r.switch_ns, r.table_ns,
+                        r.switch_ns / r.table_ns);
+        }
+    }
+}
@@ -0,0 +1,49 @@
+#!/bin/sh
+# Code size of every bench/variant_bench.cpp case, summed over its alternative-count and payload sweep.
+# Each case is built alone per library, once as is and once with VARIANT_BENCH_EMPTY, which keeps the
+# harness and the inputs but times an empty body; the reported number is the .text difference.
+# CASES narrows the list.
+CXX=${CXX:-g++}
+JOBS=${JOBS:-8}
+CASES=${CASES:-"construct copy_ctor move_ctor copy_assign_same copy_assign_cross move_assign_same move_assign_cross
+    emplace swap_same swap_cross visit visit2 visit3 eq ne lt gt le ge sort lower_bound get get_if"}
+cd "$(dirname "$0")"
+out=$(mktemp -d)
+trap 'rm -rf "$out"' EXIT
+
+libraries="variant std::variant"
+if echo '#include <boost/variant2/variant.hpp>' | $CXX -std=c++20 -fsyntax-only -x c++ - 2>/dev/null; then
+    libraries="$libraries boost::variant2"
+fi
+
+binary() {
+    echo "$out/$(echo "$1" | tr -c 'a-z0-9\n' _)-$2$3"
+}
+
+jobs=0
+for library in $libraries; do
+    for case in $CASES; do
+        for empty in "" -empty; do
+            $CXX -std=c++20 -O2 -w -DVARIANT_BENCH_LIBRARY="\"$library\"" -DVARIANT_BENCH_ONLY="\"$case\"" \
+                ${empty:+-DVARIANT_BENCH_EMPTY} variant_bench.cpp -o "$(binary "$library" "$case" "$empty")" &
+            jobs=$((jobs + 1))
+            [ $((jobs % JOBS)) -eq 0 ] && wait
+        done
+    done
+done
+wait
+
+text() {
+    size "$(binary "$@")" | awk 'NR == 2 { print $1 }'
+}
+
+printf '%-20s' case
+for library in $libraries; do printf ' %16s' "$library"; done
+echo
+for case in $CASES; do
+    printf '%-20s' "$case"
+    for library in $libraries; do
+        printf ' %16s' $(($(text "$library" "$case") - $(text "$library" "$case" -empty)))
+    done
+    echo
+done
@@ -0,0 +1,127 @@
+#include "../variant.h"
+#include "variant_probe.h"
+#include <cstdio>
+#include <cstdlib>
+#include <utility>
+#include <variant>
+
+template <>
+struct is_trivially_relocatable<probe<2>> : std::true_type {};
+
+template <>
+struct is_trivially_relocatable<probe<3>> : std::true_type {};
+
+namespace {
+
+struct nothrow_probes {
+    template <template <typename...> typename Variant>
+    using type = Variant<probe<0>, probe<1>>;
+
+    static void prepare(auto&) {}
+};
+
+struct relocatable_probes {
+    template <template <typename...> typename Variant>
+    using type = Variant<probe<2>, probe<3>>;
+
+    static void prepare(auto&) {}
+};
+
+#if VARIANT_EXCEPTIONS
+struct valueless_probes {
+    template <template <typename...> typename Variant>
+    using type = Variant<probe<0, false>, probe<1, false>>;
+
+    static void prepare(auto& v) {
+        try {
+            v.template emplace<1>(probe_failure{});
+        } catch (probe_failure const&) {
+        }
+    }
+};
+#endif
+
+template <typename Family, template <typename...> typename Variant, typename InPlace>
+struct operations {
+    using V = typename Family::template type<Variant>;
+
+    template <typename Body>
+    static probe_counts count(Body body) {
+        V a(InPlace::template index<0>, 1);
+        V b(InPlace::template index<0>, 2);
+        V c(InPlace::template index<1>, 3);
+        Family::prepare(a);
+        probe_scope scope;
+        body(a, b, c);
+        return scope.counts();
+    }
+};
+
+struct ours_in_place {
+    template <size_t Index>
+    static constexpr auto index = in_place_index<Index>;
+};
+
+struct std_in_place {
+    template <size_t Index>
+    static constexpr auto index = std::in_place_index<Index>;
+};
+
+probe_counts expect(size_t value, size_t copy, size_t move, size_t copy_assign, size_t move_assign, size_t destroy) {
+    return { value, copy, move, copy_assign, move_assign, destroy };
+}
+
+size_t failures = 0;
+
+void check(char const* name, probe_counts const& expected, probe_counts const& mine, probe_counts const& baseline) {
+    auto cell = [](probe_counts const& c) {
+        std::printf(" %3zu %3zu %3zu %3zu %3zu %3zu", c.value_constructions, c.copy_constructions, c.move_constructions,
+                    c.copy_assignments, c.move_assignments, c.destructions);
+    };
+    std::printf("%-28s", name);
+    cell(mine);
+    std::printf("  |");
+    cell(baseline);
+    if (mine != expected) {
+        std::printf("  <- expected");
+        cell(expected);
+        ++failures;
+    }
+    std::printf("\n");
+}
+
+#define VARIANT_OPS_CASE(family, name, expected, ...)                                                                  \
+    check(name, expected,                                                                                              \
+          operations<family, variant, ours_in_place>::count([](auto& a, auto& b, auto& c) { __VA_ARGS__; }),           \
+          operations<family, std::variant, std_in_place>::count([](auto& a, auto& b, auto& c) { __VA_ARGS__; }))
+
+} // namespace
+
+int main() {
+    std::printf("%-28s %-24s  | %s\n", "operation", "variant (val cp mv =cp =mv dtor)", "std::variant");
+    VARIANT_OPS_CASE(nothrow_probes, "copy construct", expect(0, 1, 0, 0, 0, 1), auto d(a); (void)d; (void)b; (void)c);
+    VARIANT_OPS_CASE(nothrow_probes, "move construct", expect(0, 0, 1, 0, 0, 1), auto d(std::move(a)); (void)d; (void)b;
+                     (void)c);
+    VARIANT_OPS_CASE(nothrow_probes, "copy assign same", expect(0, 0, 0, 1, 0, 0), a = b; (void)c);
+    VARIANT_OPS_CASE(nothrow_probes, "copy assign cross", expect(0, 1, 0, 0, 0, 1), a = c; (void)b);
+    VARIANT_OPS_CASE(nothrow_probes, "move assign same", expect(0, 0, 0, 0, 1, 0), a = std::move(b); (void)c);
+    VARIANT_OPS_CASE(nothrow_probes, "move assign cross", expect(0, 0, 1, 0, 0, 1), a = std::move(c); (void)b);
+    VARIANT_OPS_CASE(nothrow_probes, "converting assign same", expect(1, 0, 0, 0, 1, 1), a = probe<0>(4); (void)b;
+                     (void)c);
+    VARIANT_OPS_CASE(nothrow_probes, "converting assign cross", expect(1, 0, 1, 0, 0, 2), a = probe<1>(4); (void)b;
+                     (void)c);
+    VARIANT_OPS_CASE(nothrow_probes, "emplace", expect(1, 0, 0, 0, 0, 1), a.template emplace<1>(5); (void)b; (void)c);
+    VARIANT_OPS_CASE(nothrow_probes, "swap same", expect(0, 0, 1, 0, 2, 1), a.swap(b); (void)c);
+    VARIANT_OPS_CASE(nothrow_probes, "swap cross", expect(0, 0, 3, 0, 0, 3), a.swap(c); (void)b);
+    VARIANT_OPS_CASE(nothrow_probes, "free swap cross", expect(0, 0, 3, 0, 0, 3), using std::swap; swap(a, c); (void)b);
+#if VARIANT_EXCEPTIONS
+    VARIANT_OPS_CASE(valueless_probes, "swap valueless, valued", expect(0, 0, 1, 0, 0, 1), a.swap(b); (void)c);
+    VARIANT_OPS_CASE(valueless_probes, "swap valued, valueless", expect(0, 0, 1, 0, 0, 1), b.swap(a); (void)c);
+#endif
+    VARIANT_OPS_CASE(relocatable_probes, "trivial swap cross", expect(0, 0, 0, 0, 0, 0), a.swap(c); (void)b);
+    if (failures != 0) {
+        std::fflush(stdout);
+        std::fprintf(stderr, "variant_ops: %zu operations differ from the expected counts\n", failures);
+        std::abort();
+    }
+}
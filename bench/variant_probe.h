@@ -0,0 +1,88 @@
+#pragma once
+#include <compare>
+#include <cstddef>
+
+struct probe_counts {
+    size_t value_constructions = 0;
+    size_t copy_constructions = 0;
+    size_t move_constructions = 0;
+    size_t copy_assignments = 0;
+    size_t move_assignments = 0;
+    size_t destructions = 0;
+
+    friend bool operator==(probe_counts const&, probe_counts const&) = default;
+
+    probe_counts operator-(probe_counts const& other) const noexcept {
+        return { value_constructions - other.value_constructions, copy_constructions - other.copy_constructions,
+                 move_constructions - other.move_constructions,   copy_assignments - other.copy_assignments,
+                 move_assignments - other.move_assignments,       destructions - other.destructions };
+    }
+};
+
+inline probe_counts& probe_log() noexcept {
+    static thread_local probe_counts counts;
+    return counts;
+}
+
+class probe_scope {
+public:
+    probe_scope() noexcept : start(probe_log()) {}
+
+    probe_counts counts() const noexcept {
+        return probe_log() - start;
+    }
+
+private:
+    probe_counts start;
+};
+
+struct probe_failure {};
+
+template <size_t Tag, bool NothrowMove = true>
+struct probe {
+    int value = 0;
+
+    probe() noexcept {
+        ++probe_log().value_constructions;
+    }
+
+    explicit probe(int value) noexcept : value(value) {
+        ++probe_log().value_constructions;
+    }
+
+    explicit probe(probe_failure) {
+        throw probe_failure{};
+    }
+
+    probe(probe const& other) noexcept : value(other.value) {
+        ++probe_log().copy_constructions;
+    }
+
+    probe(probe&& other) noexcept(NothrowMove) : value(other.value) {
+        ++probe_log().move_constructions;
+    }
+
+    probe& operator=(probe const& other) noexcept {
+        value = other.value;
+        ++probe_log().copy_assignments;
+        return *this;
+    }
+
+    probe& operator=(probe&& other) noexcept {
+        value = other.value;
+        ++probe_log().move_assignments;
+        return *this;
+    }
+
+    ~probe() {
+        ++probe_log().destructions;
+    }
+
+    friend bool operator==(probe const& a, probe const& b) noexcept {
+        return a.value == b.value;
+    }
+
+    friend auto operator<=>(probe const& a, probe const& b) noexcept {
+        return a.value <=> b.value;
+    }
+};
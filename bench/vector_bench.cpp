@@ -0,0 +1,117 @@
+#include "../variant_vector.h"
+#include "harness.h"
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+struct point {
+    float x;
+    float y;
+};
+
+struct segment {
+    point from;
+    point to;
+};
+
+struct label {
+    uint64_t id;
+    char text[24];
+};
+
+using value = variant<point, segment, label>;
+
+constexpr size_t count = 1 << 14;
+
+value make(size_t i) {
+    switch (i % 8) {
+    case 0:
+        return value(in_place_index<2>, label{ i, {} });
+    case 1:
+    case 2:
+        return value(in_place_index<1>, segment{ { float(i), 0 }, { 0, float(i) } });
+    default:
+        return value(in_place_index<0>, point{ float(i), float(i) * 0.5f });
+    }
+}
+
+struct weight {
+    float operator()(point const& p) const {
+        return p.x + p.y;
+    }
+
+    float operator()(segment const& s) const {
+        return s.from.x + s.to.y;
+    }
+
+    float operator()(label const& l) const {
+        return float(l.id);
+    }
+};
+
+} // namespace
+
+int main(int argc, char** argv) {
+    bench::runner runner(argc > 1 ? argv[1] : "");
+    std::vector<value> variants;
+    variant_vector<point, segment, label> columns;
+    for (size_t i = 0; i < count; ++i) {
+        variants.push_back(make(i));
+        columns.push_back(make(i));
+    }
+
+    double vector_index = runner.run("index/std::vector<variant>", count, [&variants] {
+        size_t sum = 0;
+        for (value const& v : variants) {
+            sum += v.index();
+        }
+        bench::do_not_optimize(sum);
+    });
+    double columns_index = runner.run("index/variant_vector", count, [&columns] {
+        size_t sum = 0;
+        for (auto tag : columns.indexes()) {
+            sum += tag;
+        }
+        bench::do_not_optimize(sum);
+    });
+    double vector_visit = runner.run("visit/std::vector<variant>", count, [&variants] {
+        float sum = 0;
+        for (value const& v : variants) {
+            sum += visit(weight(), v);
+        }
+        bench::do_not_optimize(sum);
+    });
+    double columns_visit = runner.run("visit/variant_vector", count, [&columns] {
+        float sum = 0;
+        for (size_t i = 0; i < columns.size(); ++i) {
+            sum += columns[i].visit(weight());
+        }
+        bench::do_not_optimize(sum);
+    });
+    double vector_points = runner.run("points/std::vector<variant>", count, [&variants] {
+        float sum = 0;
+        for (value const& v : variants) {
+            if (holds_alternative<point>(v)) {
+                sum += weight()(get<point>(v));
+            }
+        }
+        bench::do_not_optimize(sum);
+    });
+    double columns_points = runner.run("points/variant_vector", count, [&columns] {
+        float sum = 0;
+        for (point const& p : columns.alternative<point>()) {
+            sum += weight()(p);
+        }
+        bench::do_not_optimize(sum);
+    });
+
+    std::printf("%zu elements: std::vector<variant> %zu bytes, variant_vector %zu bytes\n", count,
+                count * sizeof(value),
+                columns.indexes().size_bytes() + count * sizeof(uint32_t) + columns.alternative<point>().size_bytes() +
+                    columns.alternative<segment>().size_bytes() + columns.alternative<label>().size_bytes());
+    std::printf("%-24s %20s %16s\n", "case (ns/element)", "std::vector<variant>", "variant_vector");
+    std::printf("%-24s %20.2f %16.2f\n", "index()", vector_index, columns_index);
+    std::printf("%-24s %20.2f %16.2f\n", "visit", vector_visit, columns_visit);
+    std::printf("%-24s %20.2f %16.2f\n", "points only", vector_points, columns_points);
+}
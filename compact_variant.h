@@ -0,0 +1,338 @@
+#pragma once
+#include "variant.h"
+#include <new>
+#include <utility>
+
+namespace variant_utils {
+
+    template <size_t Size, size_t Align>
+    class box_pool {
+    public:
+        static void* allocate() {
+            free_list& list = cache();
+            if (list.head == nullptr) {
+                return ::operator new(Size, std::align_val_t(Align));
+            }
+            node* result = list.head;
+            list.head = result->next;
+            --list.count;
+            return result;
+        }
+
+        static void deallocate(void* p) noexcept {
+            free_list& list = cache();
+            if (list.count >= max_cached) {
+                ::operator delete(p, Size, std::align_val_t(Align));
+                return;
+            }
+            list.head = ::new (p) node{ list.head };
+            ++list.count;
+        }
+
+    private:
+        struct node {
+            node* next;
+        };
+
+        struct free_list {
+            node* head = nullptr;
+            size_t count = 0;
+
+            ~free_list() {
+                while (head != nullptr) {
+                    node* next = head->next;
+                    ::operator delete(head, Size, std::align_val_t(Align));
+                    head = next;
+                }
+            }
+        };
+
+        static constexpr size_t max_cached = 1024;
+
+        static free_list& cache() noexcept {
+            static thread_local free_list list;
+            return list;
+        }
+    };
+
+    template <typename T>
+    class boxed {
+        using pool = box_pool<std::max(sizeof(T), sizeof(void*)), std::max(alignof(T), alignof(void*))>;
+
+    public:
+        template <typename... Args>
+            requires(std::is_constructible_v<T, Args...> &&
+                     !(sizeof...(Args) == 1 && (std::is_same_v<std::remove_cvref_t<Args>, boxed> && ...)))
+        explicit boxed(Args&&... args) : value(create(std::forward<Args>(args)...)) {}
+
+        boxed(boxed const& other) requires std::is_copy_constructible_v<T>
+            : value(other.value == nullptr ? nullptr : create(*other)) {}
+
+        boxed(boxed&& other) noexcept : value(std::exchange(other.value, nullptr)) {}
+
+        boxed& operator=(boxed const& other) requires std::is_copy_assignable_v<T> {
+            if (other.value == nullptr) {
+                release();
+            }
+            else if (value == nullptr) {
+                value = create(*other);
+            }
+            else {
+                *value = *other;
+            }
+            return *this;
+        }
+
+        boxed& operator=(boxed&& other) noexcept {
+            std::swap(value, other.value);
+            return *this;
+        }
+
+        ~boxed() {
+            release();
+        }
+
+        T& operator*() noexcept {
+            return *value;
+        }
+
+        T const& operator*() const noexcept {
+            return *value;
+        }
+
+        friend bool operator==(boxed const& a, boxed const& b) requires std::equality_comparable<T> {
+            if (a.value == nullptr || b.value == nullptr) {
+                return a.value == b.value;
+            }
+            return *a == *b;
+        }
+
+        friend auto operator<=>(boxed const& a, boxed const& b) requires std::three_way_comparable<T> {
+            using ordering = std::compare_three_way_result_t<T>;
+            if (a.value == nullptr || b.value == nullptr) {
+                return ordering((a.value != nullptr) <=> (b.value != nullptr));
+            }
+            return ordering(*a <=> *b);
+        }
+
+    private:
+        void release() noexcept {
+            if (value != nullptr) {
+                std::destroy_at(value);
+                pool::deallocate(std::exchange(value, nullptr));
+            }
+        }
+
+        template <typename... Args>
+        static T* create(Args&&... args) {
+            void* memory = pool::allocate();
+#if VARIANT_EXCEPTIONS
+            try {
+                return ::new (memory) T(std::forward<Args>(args)...);
+            } catch (...) {
+                pool::deallocate(memory);
+                throw;
+            }
+#else
+            return ::new (memory) T(std::forward<Args>(args)...);
+#endif
+        }
+
+        T* value;
+    };
+
+    template <size_t Cap, typename T>
+    using box_if_larger_t = std::conditional_t<(sizeof(T) > Cap), boxed<T>, T>;
+
+} // namespace variant_utils
+
+template <typename T>
+struct is_trivially_relocatable<variant_utils::boxed<T>> : std::true_type {};
+
+template <size_t Cap, typename... Types>
+class compact_variant {
+    template <size_t Index>
+    using alternative_type = variant_utils::type_at_t<Index, Types...>;
+
+    template <size_t Index>
+    static constexpr bool is_boxed = (sizeof(alternative_type<Index>) > Cap);
+
+public:
+    using storage_type = variant<variant_utils::box_if_larger_t<Cap, Types>...>;
+
+    constexpr compact_variant() = default;
+
+    template <size_t Index, typename... Args>
+        requires(Index < sizeof...(Types) && std::is_constructible_v<alternative_type<Index>, Args...>)
+    constexpr explicit compact_variant(in_place_index_t<Index>, Args&&... args)
+        : storage(in_place_index<Index>, std::forward<Args>(args)...) {}
+
+    template <typename T, typename... Args>
+        requires(variant_utils::exactly_once_v<T, Types...> && std::is_constructible_v<T, Args...>)
+    constexpr explicit compact_variant(in_place_type_t<T>, Args&&... args)
+        : compact_variant(in_place_index<variant_utils::index_chooser_v<T, Types...>>, std::forward<Args>(args)...) {}
+
+    template <typename T>
+        requires(!std::is_same_v<std::decay_t<T>, compact_variant> &&
+                 std::is_constructible_v<variant_utils::find_overload_t<T, Types...>, T>)
+    constexpr compact_variant(T&& t)
+        : compact_variant(in_place_type<variant_utils::find_overload_t<T, Types...>>, std::forward<T>(t)) {}
+
+    template <typename T>
+        requires(!std::is_same_v<std::decay_t<T>, compact_variant> &&
+                 std::is_constructible_v<variant_utils::find_overload_t<T, Types...>, T>)
+    compact_variant& operator=(T&& t) {
+        using Target = variant_utils::find_overload_t<T, Types...>;
+        constexpr size_t Index = variant_utils::index_chooser_v<Target, Types...>;
+        if (index() == Index) {
+            get(in_place_index<Index>) = std::forward<T>(t);
+        }
+        else {
+            emplace<Index>(std::forward<T>(t));
+        }
+        return *this;
+    }
+
+    template <size_t Index, typename... Args>
+    alternative_type<Index>& emplace(Args&&... args) {
+        storage.template emplace<Index>(std::forward<Args>(args)...);
+        return get(in_place_index<Index>);
+    }
+
+    template <typename T, typename... Args>
+    T& emplace(Args&&... args) {
+        return emplace<variant_utils::index_chooser_v<T, Types...>>(std::forward<Args>(args)...);
+    }
+
+    constexpr size_t index() const noexcept {
+        return storage.index();
+    }
+
+    constexpr bool valueless_by_exception() const noexcept {
+        return storage.valueless_by_exception();
+    }
+
+    void swap(compact_variant& other) noexcept(noexcept(storage.swap(other.storage))) {
+        storage.swap(other.storage);
+    }
+
+    friend void swap(compact_variant& a, compact_variant& b) noexcept(noexcept(a.swap(b))) {
+        a.swap(b);
+    }
+
+    friend bool operator==(compact_variant const& a, compact_variant const& b)
+        requires(std::equality_comparable<Types> && ...) {
+        return a.storage == b.storage;
+    }
+
+    friend auto operator<=>(compact_variant const& a, compact_variant const& b)
+        requires(std::three_way_comparable<Types> && ...) {
+        return a.storage <=> b.storage;
+    }
+
+private:
+    friend struct variant_utils::variant_access;
+
+    template <size_t Index>
+    constexpr auto& get(in_place_index_t<Index>) {
+        if constexpr (is_boxed<Index>) {
+            return *variant_utils::variant_access::get<Index>(storage);
+        }
+        else {
+            return variant_utils::variant_access::get<Index>(storage);
+        }
+    }
+
+    template <size_t Index>
+    constexpr auto const& get(in_place_index_t<Index>) const {
+        if constexpr (is_boxed<Index>) {
+            return *variant_utils::variant_access::get<Index>(storage);
+        }
+        else {
+            return variant_utils::variant_access::get<Index>(storage);
+        }
+    }
+
+    storage_type storage;
+};
+
+template <size_t Cap, typename... Types>
+struct variant_size<compact_variant<Cap, Types...>> : std::integral_constant<size_t, sizeof...(Types)> {};
+
+template <size_t Index, size_t Cap, typename... Types>
+struct variant_alternative<Index, compact_variant<Cap, Types...>> {
+    using type = variant_utils::type_at_t<Index, Types...>;
+};
+
+template <size_t Cap, typename... Types>
+struct is_trivially_relocatable<compact_variant<Cap, Types...>>
+    : is_trivially_relocatable<typename compact_variant<Cap, Types...>::storage_type> {};
+
+template <size_t Index, size_t Cap, class... Types>
+constexpr variant_alternative_t<Index, compact_variant<Cap, Types...>>& get(compact_variant<Cap, Types...>& v) {
+    variant_utils::check_access(Index == v.index());
+    return variant_utils::variant_access::get<Index>(v);
+}
+
+template <size_t Index, size_t Cap, class... Types>
+constexpr variant_alternative_t<Index, compact_variant<Cap, Types...>>&& get(compact_variant<Cap, Types...>&& v) {
+    return std::move(get<Index>(v));
+}
+
+template <size_t Index, size_t Cap, class... Types>
+constexpr const variant_alternative_t<Index, compact_variant<Cap, Types...>>&
+get(const compact_variant<Cap, Types...>& v) {
+    variant_utils::check_access(Index == v.index());
+    return variant_utils::variant_access::get<Index>(v);
+}
+
+template <size_t Index, size_t Cap, class... Types>
+constexpr const variant_alternative_t<Index, compact_variant<Cap, Types...>>&&
+get(const compact_variant<Cap, Types...>&& v) {
+    return std::move(get<Index>(v));
+}
+
+template <class T, size_t Cap, class... Types>
+constexpr T& get(compact_variant<Cap, Types...>& v) {
+    return get<variant_utils::index_chooser_v<T, Types...>>(v);
+}
+
+template <class T, size_t Cap, class... Types>
+constexpr T&& get(compact_variant<Cap, Types...>&& v) {
+    return get<variant_utils::index_chooser_v<T, Types...>>(std::move(v));
+}
+
+template <class T, size_t Cap, class... Types>
+constexpr const T& get(const compact_variant<Cap, Types...>& v) {
+    return get<variant_utils::index_chooser_v<T, Types...>>(v);
+}
+
+template <class T, size_t Cap, class... Types>
+constexpr const T&& get(const compact_variant<Cap, Types...>&& v) {
+    return get<variant_utils::index_chooser_v<T, Types...>>(std::move(v));
+}
+
+template <size_t Index, size_t Cap, class... Types>
+constexpr auto get_if(compact_variant<Cap, Types...>* pv) noexcept {
+    return pv->index() == Index ? std::addressof(variant_utils::variant_access::get<Index>(*pv)) : nullptr;
+}
+
+template <size_t Index, size_t Cap, class... Types>
+constexpr auto get_if(const compact_variant<Cap, Types...>* pv) noexcept {
+    return pv->index() == Index ? std::addressof(variant_utils::variant_access::get<Index>(*pv)) : nullptr;
+}
+
+template <class T, size_t Cap, class... Types>
+constexpr auto get_if(compact_variant<Cap, Types...>* pv) noexcept {
+    return get_if<variant_utils::index_chooser_v<T, Types...>>(pv);
+}
+
+template <class T, size_t Cap, class... Types>
+constexpr auto get_if(const compact_variant<Cap, Types...>* pv) noexcept {
+    return get_if<variant_utils::index_chooser_v<T, Types...>>(pv);
+}
+
+template <class T, size_t Cap, class... Types>
+constexpr bool holds_alternative(const compact_variant<Cap, Types...>& v) noexcept {
+    return v.index() == variant_utils::index_chooser_v<T, Types...>;
+}
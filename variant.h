@@ -3,6 +3,9 @@
 #include "variant_union.h"
 #include "variant_utils.h"
 #include <algorithm>
+#include <compare>
+#include <memory>
+#include <tuple>
 
 template <typename... Types>
 class variant {
@@ -10,13 +13,19 @@ public:
     constexpr variant() requires(!variant_utils::default_ctor<Types...>) = delete;
     constexpr variant() noexcept(variant_utils::nothrow_default_ctor<Types...>)
         requires(variant_utils::default_ctor<Types...>)
-    : storage(in_place_index<0>) {}
+    : storage(in_place_index<0>) {
+        VARIANT_COUNT(variant, construct, 0);
+    }
 
     constexpr variant(variant const& other) noexcept(variant_utils::nothrow_copy_ctor<Types...>) requires
         variant_utils::copy_ctor<Types...> {
         if (!other.valueless_by_exception()) {
             variant_utils::visit_index<void>(
-                [this, &other](auto index) { this->storage.template construct<index>(other.storage); }, other);
+                [this, &other](auto index) {
+                    VARIANT_COUNT(variant, construct, index);
+                    this->storage.template construct<index>(other.storage);
+                },
+                other);
         }
         this->index_ = other.index_;
     }
@@ -24,13 +33,16 @@ public:
         requires(variant_utils::move_ctor<Types...>) {
         if (!other.valueless_by_exception()) {
             variant_utils::visit_index<void>(
-                [this, &other](auto index) { this->storage.template construct<index>(std::move(other.storage)); },
+                [this, &other](auto index) {
+                    VARIANT_COUNT(variant, construct, index);
+                    this->storage.template construct<index>(std::move(other.storage));
+                },
                 std::move(other));
         }
         this->index_ = other.index_;
     }
 
-    variant& operator=(variant const& other) noexcept(variant_utils::nothrow_copy_assign<Types...>)
+    constexpr variant& operator=(variant const& other) noexcept(variant_utils::nothrow_copy_assign<Types...>)
         requires(variant_utils::copy_assign<Types...>) {
         if (other.valueless_by_exception()) {
             if (this->valueless_by_exception()) {
@@ -40,11 +52,12 @@ public:
             return *this;
         }
         variant_utils::visit_index<void>(
-            [this, other](auto this_index, auto other_index) {
+            [this, &other](auto this_index, auto other_index) {
                 if constexpr (this_index == other_index) {
                     ::get<this_index>(*this) = ::get<other_index>(other);
                 }
                 else {
+                    VARIANT_COUNT(variant, assign, other_index);
                     this->template emplace<other_index>(::get<other_index>(other));
                 }
             },
@@ -52,7 +65,7 @@ public:
         return *this;
     }
 
-    variant& operator=(variant&& other) noexcept(variant_utils::nothrow_move_assign<Types...>)
+    constexpr variant& operator=(variant&& other) noexcept(variant_utils::nothrow_move_assign<Types...>)
         requires(variant_utils::move_assign<Types...>) {
         if (other.valueless_by_exception()) {
             if (this->valueless_by_exception()) {
@@ -67,6 +80,7 @@ public:
                     ::get<this_index>(*this) = ::get<other_index>(std::move(other));
                 }
                 else {
+                    VARIANT_COUNT(variant, assign, other_index);
                     this->template emplace<other_index>(::get<other_index>(std::move(other)));
                 }
             },
@@ -78,9 +92,9 @@ public:
         requires(variant_utils::copy_ctor<Types...>&& variant_utils::trivial_copy_ctor<Types...>) = default;
     constexpr variant(variant&& other)
         requires(variant_utils::move_ctor<Types...>&& variant_utils::trivial_move_ctor<Types...>) = default;
-    variant& operator=(variant const& other)
+    constexpr variant& operator=(variant const& other)
         requires(variant_utils::copy_assign<Types...>&& variant_utils::trivial_copy_assign<Types...>) = default;
-    variant& operator=(variant&& other)
+    constexpr variant& operator=(variant&& other)
         requires(variant_utils::move_assign<Types...>&& variant_utils::trivial_move_assign<Types...>) = default;
 
     template <typename T>
@@ -100,6 +114,7 @@ public:
             ::get<variant_utils::index_chooser_v<Target, Types...>>(*this) = std::forward<T>(t);
         }
         else {
+            VARIANT_COUNT(variant, assign, (variant_utils::index_chooser_v<Target, Types...>));
             if constexpr (std::is_nothrow_constructible_v<Target, T> || !std::is_nothrow_move_constructible_v<Target>) {
                 this->template emplace<variant_utils::index_chooser_v<Target, Types...>>(std::forward<T>(t));
             }
@@ -120,28 +135,102 @@ public:
         requires(Index < sizeof...(Types) &&
     std::is_constructible_v<variant_alternative_t<Index, variant<Types...>>,
         Args...>) explicit constexpr variant(in_place_index_t<Index>, Args&&... args)
-        : storage(in_place_index<Index>, std::forward<Args>(args)...), index_(Index) {}
+        : storage(in_place_index<Index>, std::forward<Args>(args)...), index_(static_cast<index_type>(Index)) {
+        VARIANT_COUNT(variant, construct, Index);
+    }
 
     template <typename T, typename... Args>
         requires(variant_utils::exactly_once_v<T, Types...>&& std::is_constructible_v<T, Args...>) constexpr explicit variant(
     in_place_type_t<T>, Args&&... args)
         : variant(in_place_index<variant_utils::index_chooser_v<T, Types...>>, std::forward<Args>(args)...) {}
 
+    template <typename Alloc>
+        requires(variant_utils::default_ctor<Types...>)
+    constexpr variant(std::allocator_arg_t, Alloc const& alloc) : variant(std::allocator_arg, alloc, in_place_index<0>) {}
+
+    template <typename Alloc, size_t Index, typename... Args>
+        requires(Index < sizeof...(Types) &&
+                 variant_utils::uses_allocator_ctor<variant_alternative_t<Index, variant<Types...>>, Alloc, Args...>)
+    constexpr explicit variant(std::allocator_arg_t, Alloc const& alloc, in_place_index_t<Index>, Args&&... args)
+        : variant(std::piecewise_construct, in_place_index<Index>,
+                  std::uses_allocator_construction_args<variant_alternative_t<Index, variant>>(alloc, std::forward<Args>(args)...)) {}
+
+    template <typename Alloc, typename T, typename... Args>
+        requires(variant_utils::exactly_once_v<T, Types...> && variant_utils::uses_allocator_ctor<T, Alloc, Args...>)
+    constexpr explicit variant(std::allocator_arg_t, Alloc const& alloc, in_place_type_t<T>, Args&&... args)
+        : variant(std::allocator_arg, alloc, in_place_index<variant_utils::index_chooser_v<T, Types...>>,
+                  std::forward<Args>(args)...) {}
+
+    template <typename Alloc, typename T>
+        requires(!std::is_same_v<std::decay_t<T>, variant> &&
+                 std::is_constructible_v<variant_utils::find_overload_t<T, Types...>, T>)
+    constexpr variant(std::allocator_arg_t, Alloc const& alloc, T&& t)
+        : variant(std::allocator_arg, alloc, in_place_type<variant_utils::find_overload_t<T, Types...>>, std::forward<T>(t)) {}
+
+    template <typename Alloc>
+        requires(variant_utils::copy_ctor<Types...>)
+    constexpr variant(std::allocator_arg_t, Alloc const& alloc, variant const& other) {
+        if (!other.valueless_by_exception()) {
+            variant_utils::visit_index<void>(
+                [this, &alloc, &other](auto index) {
+                    VARIANT_COUNT(variant, construct, index);
+                    this->template construct_using_allocator<index>(alloc, variant_utils::variant_access::get<index>(other));
+                },
+                other);
+        }
+        this->index_ = other.index_;
+    }
+
+    template <typename Alloc>
+        requires(variant_utils::move_ctor<Types...>)
+    constexpr variant(std::allocator_arg_t, Alloc const& alloc, variant&& other) {
+        if (!other.valueless_by_exception()) {
+            variant_utils::visit_index<void>(
+                [this, &alloc, &other](auto index) {
+                    VARIANT_COUNT(variant, construct, index);
+                    this->template construct_using_allocator<index>(
+                        alloc, variant_utils::variant_access::get<index>(std::move(other)));
+                },
+                other);
+        }
+        this->index_ = other.index_;
+    }
+
     template <class T, class... Args>
-    T& emplace(Args&&... args) {
+    constexpr T& emplace(Args&&... args) {
         return emplace<variant_utils::index_chooser_v<T, Types...>>(std::forward<Args>(args)...);
     }
 
     template <size_t Index, class... Args>
-    variant_alternative_t<Index, variant>& emplace(Args&&... args) {
-        this->reset();
-        auto& res = this->storage.template emplace<Index>(in_place_index<Index>, std::forward<Args>(args)...);
-        this->index_ = Index;
-        return res;
+    constexpr variant_alternative_t<Index, variant>& emplace(Args&&... args) {
+        using Alternative = variant_alternative_t<Index, variant>;
+        VARIANT_COUNT(variant, emplace, Index);
+        if constexpr (variant_utils::never_valueless<Types...> && !std::is_nothrow_constructible_v<Alternative, Args...>) {
+            Alternative value(std::forward<Args>(args)...);
+            return this->template commit<Index>(std::move(value));
+        }
+        else {
+            this->reset();
+            auto& res = this->storage.template emplace<Index>(in_place_index<Index>, std::forward<Args>(args)...);
+            this->index_ = static_cast<index_type>(Index);
+            return res;
+        }
     }
 
-    void swap(variant& other) noexcept(((std::is_nothrow_move_constructible_v<Types>&&
+    constexpr void swap(variant& other) noexcept(((std::is_nothrow_move_constructible_v<Types>&&
         std::is_nothrow_swappable_v<Types>)&&...)) {
+        if constexpr (variant_utils::trivial_swap<Types...>) {
+            if (!std::is_constant_evaluated()) {
+                alignas(variant_utils::variant_union<Types...>) std::byte tmp[sizeof(this->storage)];
+                void* lhs = std::addressof(this->storage);
+                void* rhs = std::addressof(other.storage);
+                std::memcpy(tmp, lhs, sizeof(tmp));
+                std::memcpy(lhs, rhs, sizeof(tmp));
+                std::memcpy(rhs, tmp, sizeof(tmp));
+                std::swap(this->index_, other.index_);
+                return;
+            }
+        }
         if (valueless_by_exception() && other.valueless_by_exception()) {
             return;
         }
@@ -165,6 +254,9 @@ public:
                         using std::swap;
                         swap(::get<this_index>(*this), ::get<this_index>(other));
                     }
+                    else if constexpr (variant_utils::nothrow_move_ctor<Types...>) {
+                        this->template swap_alternatives<this_index, other_index>(other);
+                    }
                     else {
                         std::swap(*this, other);
                     }
@@ -174,14 +266,29 @@ public:
     }
 
     constexpr size_t index() const noexcept {
-        return this->index_;
+        if constexpr (variant_utils::never_valueless<Types...>) {
+            return this->index_;
+        }
+        else {
+            return this->index_ == index_npos ? variant_npos : this->index_;
+        }
     }
 
     constexpr bool valueless_by_exception() const noexcept {
-        return this->index_ == variant_npos;
+        if constexpr (variant_utils::never_valueless<Types...>) {
+            return false;
+        }
+        else {
+            return this->index_ == index_npos;
+        }
     }
 
 private:
+    using index_type = variant_utils::index_type_t<sizeof...(Types)>;
+    static constexpr index_type index_npos = variant_utils::index_npos_v<sizeof...(Types)>;
+
+    friend struct variant_utils::variant_access;
+
     template <size_t Index, class... Args>
     friend constexpr variant_alternative_t<Index, variant<Args...>>& get(variant<Args...>& v);
     template <std::size_t Index, class... Args>
@@ -191,6 +298,27 @@ private:
     template <std::size_t Index, class... Args>
     friend constexpr const variant_alternative_t<Index, variant<Args...>>&& get(const variant<Args...>&& v);
 
+    template <size_t Index, typename Tuple>
+    constexpr variant(std::piecewise_construct_t, in_place_index_t<Index>, Tuple&& args)
+        : variant(std::piecewise_construct, in_place_index<Index>, std::forward<Tuple>(args),
+                  std::make_index_sequence<std::tuple_size_v<std::remove_cvref_t<Tuple>>>()) {}
+
+    template <size_t Index, typename Tuple, size_t... Positions>
+    constexpr variant(std::piecewise_construct_t, in_place_index_t<Index>, Tuple&& args, std::index_sequence<Positions...>)
+        : storage(in_place_index<Index>, std::get<Positions>(std::forward<Tuple>(args))...),
+          index_(static_cast<index_type>(Index)) {
+        VARIANT_COUNT(variant, construct, Index);
+    }
+
+    template <size_t Index, typename Alloc, typename... Args>
+    constexpr void construct_using_allocator(Alloc const& alloc, Args&&... args) {
+        std::apply(
+            [this](auto&&... args) {
+                this->storage.template emplace<Index>(in_place_index<Index>, std::forward<decltype(args)>(args)...);
+            },
+            std::uses_allocator_construction_args<variant_alternative_t<Index, variant>>(alloc, std::forward<Args>(args)...));
+    }
+
     template <size_t Index>
     constexpr auto& get(in_place_index_t<Index>) {
         return this->storage.get(in_place_index<Index>);
@@ -201,17 +329,68 @@ private:
         return this->storage.get(in_place_index<Index>);
     }
 
-    void reset() {
-        if (index_ != variant_npos) {
-            variant_utils::visit_index<void>([this](auto this_index) { this->storage.template reset<this_index>(); }, *this);
-            index_ = variant_npos;
+    constexpr void reset() {
+        if constexpr (variant_utils::never_valueless<Types...>) {
+            variant_utils::visit_index<void>(
+                [this](auto this_index) {
+                    VARIANT_COUNT(variant, reset, this_index);
+                    this->storage.template reset<this_index>();
+                },
+                *this);
+        }
+        else if (index_ != index_npos) {
+            variant_utils::visit_index<void>(
+                [this](auto this_index) {
+                    VARIANT_COUNT(variant, reset, this_index);
+                    this->storage.template reset<this_index>();
+                },
+                *this);
+            index_ = index_npos;
         }
     }
 
+    template <size_t Index>
+    constexpr variant_alternative_t<Index, variant>& commit(variant_alternative_t<Index, variant>&& value) noexcept {
+        this->reset();
+        auto& res = this->storage.template emplace<Index>(in_place_index<Index>, std::move(value));
+        this->index_ = static_cast<index_type>(Index);
+        return res;
+    }
+
+    template <size_t ThisIndex, size_t OtherIndex>
+    constexpr void swap_alternatives(variant& other) noexcept {
+        variant_alternative_t<ThisIndex, variant> tmp(std::move(this->storage.get(in_place_index<ThisIndex>)));
+        this->storage.template reset<ThisIndex>();
+        this->storage.template emplace<OtherIndex>(in_place_index<OtherIndex>,
+                                                   std::move(other.storage.get(in_place_index<OtherIndex>)));
+        other.storage.template reset<OtherIndex>();
+        other.storage.template emplace<ThisIndex>(in_place_index<ThisIndex>, std::move(tmp));
+        std::swap(this->index_, other.index_);
+    }
+
     variant_utils::variant_union<Types...> storage;
-    size_t index_{ 0 };
+    index_type index_{ 0 };
 };
 
+static_assert(sizeof(variant<char>) == 2);
+static_assert(sizeof(variant<int, float>) == 8);
+static_assert(sizeof(variant<double, int>) == 16);
+static_assert(std::is_trivially_copyable_v<variant<int, float>>);
+static_assert([] {
+    variant<int, double> v(1), w(2.5);
+    v.emplace<1>(0.5);
+    v.swap(w);
+    w = v;
+    v = 4.0;
+    return get<1>(v) == 4.0 && get<1>(w) == 2.5;
+}());
+
+template <class... Types>
+    requires(variant_utils::move_ctor<Types...> && (std::is_swappable_v<Types> && ...))
+constexpr void swap(variant<Types...>& v, variant<Types...>& w) noexcept(noexcept(v.swap(w))) {
+    v.swap(w);
+}
+
 template <class T, class... Types>
 constexpr bool holds_alternative(const variant<Types...>& v) noexcept {
     return v.index() == variant_utils::index_chooser_v<T, Types...>;
@@ -246,130 +425,128 @@ constexpr std::add_pointer_t<const T> get_if(const variant<Args...>* pv) noexcep
 
 template <class... Types>
 constexpr bool operator==(const variant<Types...>& v, const variant<Types...>& w) {
+    if (v.index() != w.index()) {
+        return false;
+    }
+    if (v.valueless_by_exception()) {
+        return true;
+    }
     return variant_utils::visit_index<bool>(
-        [&v, &w](auto index1, auto index2) {
-            if constexpr (index1 != index2) {
-                return false;
-            }
-            else {
-                if (v.valueless_by_exception()) {
-                    return true;
-                }
-                else {
-                    return get<index1>(v) == get<index2>(w);
-                }
-            }
+        [&v, &w](auto index) -> bool {
+            return variant_utils::variant_access::get<index>(v) == variant_utils::variant_access::get<index>(w);
         },
-        v, w);
+        v);
 }
 
 template <class... Types>
 constexpr bool operator!=(const variant<Types...>& v, const variant<Types...>& w) {
+    if (v.index() != w.index()) {
+        return true;
+    }
+    if (v.valueless_by_exception()) {
+        return false;
+    }
     return variant_utils::visit_index<bool>(
-        [&v, &w](auto index1, auto index2) {
-            if constexpr (index1 != index2) {
-                return true;
-            }
-            else {
-                if (v.valueless_by_exception()) {
-                    return false;
-                }
-                else {
-                    return get<index1>(v) != get<index2>(w);
-                }
-            }
+        [&v, &w](auto index) -> bool {
+            return variant_utils::variant_access::get<index>(v) != variant_utils::variant_access::get<index>(w);
         },
-        v, w);
+        v);
 }
 
 template <class... Types>
 constexpr bool operator<(const variant<Types...>& v, const variant<Types...>& w) {
-    if (w.valueless_by_exception()) {
-        return false;
+    if (v.index() != w.index()) {
+        return v.index() + 1 < w.index() + 1;
     }
-    else if (v.valueless_by_exception()) {
-        return true;
+    if (v.valueless_by_exception()) {
+        return false;
     }
     return variant_utils::visit_index<bool>(
-        [&v, &w](auto index1, auto index2) -> bool {
-            if constexpr (index1 < index2) {
-                return true;
-            }
-            else if constexpr (index1 > index2) {
-                return false;
-            }
-            else {
-                return get<index1>(v) < get<index2>(w);
-            }
+        [&v, &w](auto index) -> bool {
+            return variant_utils::variant_access::get<index>(v) < variant_utils::variant_access::get<index>(w);
         },
-        v, w);
+        v);
 }
 
 template <class... Types>
 constexpr bool operator>(const variant<Types...>& v, const variant<Types...>& w) {
+    if (v.index() != w.index()) {
+        return v.index() + 1 > w.index() + 1;
+    }
     if (v.valueless_by_exception()) {
         return false;
     }
-    else if (w.valueless_by_exception()) {
-        return true;
-    }
     return variant_utils::visit_index<bool>(
-        [&v, &w](auto index1, auto index2) -> bool {
-            if constexpr (index1 > index2) {
-                return true;
-            }
-            else if constexpr (index1 < index2) {
-                return false;
-            }
-            else {
-                return get<index1>(v) > get<index2>(w);
-            }
+        [&v, &w](auto index) -> bool {
+            return variant_utils::variant_access::get<index>(v) > variant_utils::variant_access::get<index>(w);
         },
-        v, w);
+        v);
 }
 
 template <class... Types>
 constexpr bool operator<=(const variant<Types...>& v, const variant<Types...>& w) {
+    if (v.index() != w.index()) {
+        return v.index() + 1 < w.index() + 1;
+    }
     if (v.valueless_by_exception()) {
         return true;
     }
-    else if (w.valueless_by_exception()) {
-        return false;
-    }
     return variant_utils::visit_index<bool>(
-        [&v, &w](auto index1, auto index2) -> bool {
-            if constexpr (index1 < index2) {
-                return true;
-            }
-            else if constexpr (index1 > index2) {
-                return false;
-            }
-            else {
-                return get<index1>(v) <= get<index2>(w);
-            }
+        [&v, &w](auto index) -> bool {
+            return variant_utils::variant_access::get<index>(v) <= variant_utils::variant_access::get<index>(w);
         },
-        v, w);
+        v);
 }
 
 template <class... Types>
 constexpr bool operator>=(const variant<Types...>& v, const variant<Types...>& w) {
-    if (w.valueless_by_exception()) {
-        return true;
+    if (v.index() != w.index()) {
+        return v.index() + 1 > w.index() + 1;
     }
-    else if (v.valueless_by_exception()) {
-        return false;
+    if (v.valueless_by_exception()) {
+        return true;
     }
     return variant_utils::visit_index<bool>(
-        [&v, &w](auto index1, auto index2) -> bool {
-            if constexpr (index1 > index2) {
-                return true;
-            }
-            else if constexpr (index1 < index2) {
-                return false;
-            }
-            else {
-                return get<index1>(v) >= get<index2>(w);
-            }
+        [&v, &w](auto index) -> bool {
+            return variant_utils::variant_access::get<index>(v) >= variant_utils::variant_access::get<index>(w);
         },
-        v, w);
-}
\ No newline at end of file
+        v);
+}
+
+template <class... Types>
+    requires(std::three_way_comparable<Types> && ...)
+constexpr std::common_comparison_category_t<std::compare_three_way_result_t<Types>...>
+operator<=>(const variant<Types...>& v, const variant<Types...>& w) {
+    using R = std::common_comparison_category_t<std::compare_three_way_result_t<Types>...>;
+    if (v.index() != w.index()) {
+        return v.index() + 1 <=> w.index() + 1;
+    }
+    if (v.valueless_by_exception()) {
+        return std::strong_ordering::equal;
+    }
+    return variant_utils::visit_index<R>(
+        [&v, &w](auto index) -> R {
+            return variant_utils::variant_access::get<index>(v) <=> variant_utils::variant_access::get<index>(w);
+        },
+        v);
+}
+
+template <>
+struct std::hash<monostate> {
+    size_t operator()(monostate) const noexcept {
+        return variant_utils::hash_finalize(0);
+    }
+};
+
+template <class... Types>
+    requires(variant_utils::std_hashable<std::remove_const_t<Types>> && ...)
+struct std::hash<variant<Types...>> {
+    size_t operator()(const variant<Types...>& v) const {
+        if (v.valueless_by_exception()) {
+            return variant_utils::hash_mix(variant_npos, 0);
+        }
+        return variant_utils::visit_index<size_t>(
+            [&v](auto index) { return variant_utils::hash_mix(index, variant_utils::hash_alternative(::get<index>(v))); },
+            v);
+    }
+};
@@ -0,0 +1,120 @@
+#pragma once
+#include "variant.h"
+#include <algorithm>
+#include <iterator>
+#include <ranges>
+#include <vector>
+
+namespace variant_utils {
+
+inline constexpr size_t hash_block_size = 256;
+
+template <typename Variant, size_t Capacity = 0>
+struct index_buckets {
+    static constexpr size_t bucket_count = variant_size_v<Variant> + 1;
+
+    std::array<size_t, bucket_count + 1> offsets{};
+    std::conditional_t<Capacity == 0, std::vector<size_t>, std::array<size_t, Capacity>> positions;
+
+    template <size_t Index>
+    constexpr auto alternative() const {
+        return std::ranges::subrange(positions.begin() + offsets[Index + 1], positions.begin() + offsets[Index + 2]);
+    }
+
+    constexpr auto valueless() const {
+        return std::ranges::subrange(positions.begin() + offsets[0], positions.begin() + offsets[1]);
+    }
+};
+
+template <size_t Capacity = 0, std::random_access_iterator It>
+index_buckets<std::iter_value_t<It>, Capacity> bucket_by_index(It first, size_t count) {
+    using Variant = std::iter_value_t<It>;
+    index_buckets<Variant, Capacity> result;
+    std::array<size_t, index_buckets<Variant, Capacity>::bucket_count> next{};
+    for (size_t i = 0; i < count; ++i) {
+        ++next[first[i].index() + 1];
+    }
+    for (size_t bucket = 0, offset = 0; bucket < next.size(); ++bucket) {
+        result.offsets[bucket] = offset;
+        offset += next[bucket];
+        next[bucket] = result.offsets[bucket];
+    }
+    result.offsets.back() = count;
+    if constexpr (Capacity == 0) {
+        result.positions.resize(count);
+    }
+    for (size_t i = 0; i < count; ++i) {
+        result.positions[next[first[i].index() + 1]++] = i;
+    }
+    return result;
+}
+
+template <typename Variant, typename Function>
+void for_each_grouped(Variant* data, size_t count, Function&& function) {
+    auto buckets = bucket_by_index(data, count);
+    variant_utils::check_access(buckets.valueless().empty());
+    [&]<size_t... Indexes>(std::index_sequence<Indexes...>) {
+        ([&] {
+            for (size_t position : buckets.template alternative<Indexes>()) {
+                function(index_wrapper<Indexes>{}, position);
+            }
+        }(), ...);
+    }(std::make_index_sequence<variant_size_v<std::remove_const_t<Variant>>>());
+}
+
+} // namespace variant_utils
+
+template <std::random_access_iterator It, std::random_access_iterator Out>
+    requires(std::is_default_constructible_v<std::hash<std::iter_value_t<It>>>)
+Out hash_range(It first, It last, Out out) {
+    using Variant = std::iter_value_t<It>;
+    size_t count = static_cast<size_t>(last - first);
+    for (size_t begin = 0; begin < count; begin += variant_utils::hash_block_size) {
+        auto block = first + begin;
+        auto buckets = variant_utils::bucket_by_index<variant_utils::hash_block_size>(
+            block, std::min(variant_utils::hash_block_size, count - begin));
+        for (size_t position : buckets.valueless()) {
+            out[begin + position] = variant_utils::hash_mix(variant_npos, 0);
+        }
+        [&]<size_t... Indexes>(std::index_sequence<Indexes...>) {
+            ([&] {
+                for (size_t position : buckets.template alternative<Indexes>()) {
+                    auto const& value = variant_utils::variant_access::get<Indexes>(block[position]);
+                    out[begin + position] = variant_utils::hash_mix(Indexes, variant_utils::hash_alternative(value));
+                }
+            }(), ...);
+        }(std::make_index_sequence<variant_size_v<Variant>>());
+    }
+    return out + count;
+}
+
+enum class visit_order { preserve, relaxed };
+
+template <visit_order Order = visit_order::preserve, std::ranges::contiguous_range Range, typename Visitor>
+void visit_each(Range&& range, Visitor&& vis) {
+    auto* data = std::ranges::data(range);
+    size_t count = std::ranges::size(range);
+    if constexpr (Order == visit_order::preserve) {
+        for (size_t first = 0; first < count;) {
+            size_t index = data[first].index();
+            size_t last = first + 1;
+            while (last < count && data[last].index() == index) {
+                ++last;
+            }
+            variant_utils::check_access(index != variant_npos);
+            variant_utils::visit_index<void>(
+                [&vis, data, first, last](auto alternative) {
+                    for (size_t i = first; i < last; ++i) {
+                        std::invoke(vis, variant_utils::variant_access::get<alternative>(data[i]));
+                    }
+                },
+                data[first]);
+            first = last;
+        }
+    }
+    else {
+        variant_utils::for_each_grouped(data, count, [&vis, data](auto alternative, size_t position) {
+            std::invoke(vis, variant_utils::variant_access::get<alternative>(data[position]));
+        });
+    }
+}
@@ -0,0 +1,241 @@
+#pragma once
+#include "variant.h"
+#include <atomic>
+#include <bit>
+#include <memory>
+#include <new>
+#include <stdexcept>
+
+namespace variant_utils {
+
+    inline constexpr size_t cache_line_size = 64;
+
+    template <typename Value>
+    class channel_storage {
+    public:
+        Value* get() noexcept {
+            return std::launder(reinterpret_cast<Value*>(bytes));
+        }
+
+        template <size_t Index, typename... Args>
+        void emplace(Args&&... args) {
+            std::construct_at(reinterpret_cast<Value*>(bytes), in_place_index<Index>, std::forward<Args>(args)...);
+        }
+
+        void destroy() noexcept {
+            std::destroy_at(get());
+        }
+
+    private:
+        alignas(Value) std::byte bytes[sizeof(Value)];
+    };
+
+    inline size_t channel_capacity(size_t requested) {
+        if (requested == 0) {
+            variant_utils::throw_error<std::invalid_argument>("variant channel: capacity must be positive");
+        }
+        return std::bit_ceil(requested);
+    }
+
+} // namespace variant_utils
+
+template <typename... Types>
+class spsc_variant_channel {
+public:
+    using value_type = variant<Types...>;
+
+    explicit spsc_variant_channel(size_t capacity)
+        : mask(variant_utils::channel_capacity(capacity) - 1), slots(std::make_unique<slot[]>(mask + 1)) {}
+
+    spsc_variant_channel(spsc_variant_channel const&) = delete;
+    spsc_variant_channel& operator=(spsc_variant_channel const&) = delete;
+
+    ~spsc_variant_channel() {
+        while (front() != nullptr) {
+            pop();
+        }
+    }
+
+    size_t capacity() const noexcept {
+        return mask + 1;
+    }
+
+    template <size_t Index, typename... Args>
+    bool try_emplace(Args&&... args) {
+        size_t position = producer.tail.load(std::memory_order_relaxed);
+        if (position - producer.cached_head > mask) {
+            producer.cached_head = consumer.head.load(std::memory_order_acquire);
+            if (position - producer.cached_head > mask) {
+                return false;
+            }
+        }
+        slots[position & mask].template emplace<Index>(std::forward<Args>(args)...);
+        producer.tail.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    template <typename T, typename... Args>
+    bool try_emplace(Args&&... args) {
+        return try_emplace<variant_utils::index_chooser_v<T, Types...>>(std::forward<Args>(args)...);
+    }
+
+    value_type* front() noexcept {
+        size_t position = consumer.head.load(std::memory_order_relaxed);
+        if (position == consumer.cached_tail) {
+            consumer.cached_tail = producer.tail.load(std::memory_order_acquire);
+            if (position == consumer.cached_tail) {
+                return nullptr;
+            }
+        }
+        return slots[position & mask].get();
+    }
+
+    void pop() noexcept {
+        size_t position = consumer.head.load(std::memory_order_relaxed);
+        slots[position & mask].destroy();
+        consumer.head.store(position + 1, std::memory_order_release);
+    }
+
+    template <typename Visitor>
+    bool try_visit(Visitor&& vis) {
+        value_type* value = front();
+        if (value == nullptr) {
+            return false;
+        }
+        ::visit(std::forward<Visitor>(vis), *value);
+        pop();
+        return true;
+    }
+
+private:
+    using slot = variant_utils::channel_storage<value_type>;
+
+    struct alignas(variant_utils::cache_line_size) producer_side {
+        std::atomic<size_t> tail{ 0 };
+        size_t cached_head = 0;
+    };
+
+    struct alignas(variant_utils::cache_line_size) consumer_side {
+        std::atomic<size_t> head{ 0 };
+        size_t cached_tail = 0;
+    };
+
+    producer_side producer;
+    consumer_side consumer;
+    size_t mask;
+    std::unique_ptr<slot[]> slots;
+};
+
+template <typename... Types>
+class mpsc_variant_channel {
+public:
+    using value_type = variant<Types...>;
+
+    explicit mpsc_variant_channel(size_t capacity)
+        : mask(variant_utils::channel_capacity(capacity) - 1), slots(std::make_unique<slot[]>(mask + 1)) {
+        for (size_t i = 0; i <= mask; ++i) {
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    mpsc_variant_channel(mpsc_variant_channel const&) = delete;
+    mpsc_variant_channel& operator=(mpsc_variant_channel const&) = delete;
+
+    ~mpsc_variant_channel() {
+        while (front() != nullptr) {
+            pop();
+        }
+    }
+
+    size_t capacity() const noexcept {
+        return mask + 1;
+    }
+
+    template <size_t Index, typename... Args>
+    bool try_emplace(Args&&... args) {
+        size_t position = tail.load(std::memory_order_relaxed);
+        slot* target;
+        for (;;) {
+            target = &slots[position & mask];
+            size_t sequence = target->sequence.load(std::memory_order_acquire);
+            auto difference = static_cast<std::ptrdiff_t>(sequence - position);
+            if (difference == 0) {
+                if (tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            }
+            else if (difference < 0) {
+                return false;
+            }
+            else {
+                position = tail.load(std::memory_order_relaxed);
+            }
+        }
+#if VARIANT_EXCEPTIONS
+        try {
+            target->storage.template emplace<Index>(std::forward<Args>(args)...);
+        } catch (...) {
+            target->abandoned = true;
+            target->sequence.store(position + 1, std::memory_order_release);
+            throw;
+        }
+#else
+        target->storage.template emplace<Index>(std::forward<Args>(args)...);
+#endif
+        target->sequence.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    template <typename T, typename... Args>
+    bool try_emplace(Args&&... args) {
+        return try_emplace<variant_utils::index_chooser_v<T, Types...>>(std::forward<Args>(args)...);
+    }
+
+    value_type* front() noexcept {
+        for (;;) {
+            slot& target = slots[head & mask];
+            if (target.sequence.load(std::memory_order_acquire) != head + 1) {
+                return nullptr;
+            }
+            if (!target.abandoned) {
+                return target.storage.get();
+            }
+            target.abandoned = false;
+            release(target);
+        }
+    }
+
+    void pop() noexcept {
+        slot& target = slots[head & mask];
+        target.storage.destroy();
+        release(target);
+    }
+
+    template <typename Visitor>
+    bool try_visit(Visitor&& vis) {
+        value_type* value = front();
+        if (value == nullptr) {
+            return false;
+        }
+        ::visit(std::forward<Visitor>(vis), *value);
+        pop();
+        return true;
+    }
+
+private:
+    struct slot {
+        std::atomic<size_t> sequence;
+        bool abandoned = false;
+        variant_utils::channel_storage<value_type> storage;
+    };
+
+    void release(slot& target) noexcept {
+        target.sequence.store(head + mask + 1, std::memory_order_release);
+        ++head;
+    }
+
+    alignas(variant_utils::cache_line_size) std::atomic<size_t> tail{ 0 };
+    alignas(variant_utils::cache_line_size) size_t head = 0;
+    size_t mask;
+    std::unique_ptr<slot[]> slots;
+};
@@ -0,0 +1,299 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+template <typename Variant>
+struct variant_size;
+
+namespace variant_utils {
+
+    enum class counter_event : size_t { visit, construct, assign, emplace, reset };
+
+    inline constexpr size_t counter_event_count = 5;
+
+    inline constexpr std::array<std::string_view, counter_event_count> counter_event_names = { "visit", "construct",
+                                                                                                "assign", "emplace",
+                                                                                                "reset" };
+
+} // namespace variant_utils
+
+struct alternative_counters {
+    std::array<uint64_t, variant_utils::counter_event_count> events{};
+
+    uint64_t operator[](variant_utils::counter_event event) const noexcept {
+        return events[static_cast<size_t>(event)];
+    }
+
+    alternative_counters& operator+=(alternative_counters const& other) noexcept {
+        for (size_t i = 0; i < events.size(); ++i) {
+            events[i] += other.events[i];
+        }
+        return *this;
+    }
+
+    friend bool operator==(alternative_counters const&, alternative_counters const&) = default;
+};
+
+struct variant_counters {
+    std::string_view type;
+    std::vector<alternative_counters> alternatives;
+
+    variant_counters& operator+=(variant_counters const& other) {
+        alternatives.resize(std::max(alternatives.size(), other.alternatives.size()));
+        for (size_t i = 0; i < other.alternatives.size(); ++i) {
+            alternatives[i] += other.alternatives[i];
+        }
+        return *this;
+    }
+};
+
+using counters_snapshot = std::vector<variant_counters>;
+
+namespace variant_utils {
+
+    template <typename T>
+    constexpr std::string_view type_name() {
+#if defined(_MSC_VER) && !defined(__clang__)
+        std::string_view name = __FUNCSIG__;
+        size_t first = name.find("type_name<") + 10;
+        size_t last = name.rfind(">(void)");
+#else
+        std::string_view name = __PRETTY_FUNCTION__;
+        size_t first = name.find("T = ") + 4;
+        size_t last = name.find(';', first);
+        if (last == std::string_view::npos) {
+            last = name.rfind(']');
+        }
+#endif
+        return name.substr(first, last - first);
+    }
+
+    class counter_block;
+
+    class counter_site {
+    public:
+        counter_site(std::string_view type, alternative_counters* retired, size_t alternatives) noexcept
+            : type(type), retired(retired), alternatives(alternatives) {
+            std::lock_guard lock(registry_mutex());
+            next = registry();
+            registry() = this;
+        }
+
+        counter_site(counter_site const&) = delete;
+        counter_site& operator=(counter_site const&) = delete;
+
+        ~counter_site() {
+            std::lock_guard lock(registry_mutex());
+            counter_site** link = &registry();
+            while (*link != this) {
+                link = &(*link)->next;
+            }
+            *link = next;
+        }
+
+        void attach(counter_block* block) noexcept;
+
+        void detach(counter_block* block) noexcept;
+
+        variant_counters collect() const;
+
+        static counters_snapshot snapshot() {
+            std::lock_guard lock(registry_mutex());
+            counters_snapshot result;
+            for (counter_site const* site = registry(); site != nullptr; site = site->next) {
+                result.push_back(site->collect());
+            }
+            std::reverse(result.begin(), result.end());
+            return result;
+        }
+
+    private:
+        static counter_site*& registry() noexcept {
+            static counter_site* head = nullptr;
+            return head;
+        }
+
+        static std::mutex& registry_mutex() noexcept {
+            static std::mutex mutex;
+            return mutex;
+        }
+
+        std::string_view type;
+        mutable std::mutex mutex;
+        alternative_counters* retired;
+        size_t alternatives;
+        counter_block* blocks = nullptr;
+        counter_site* next = nullptr;
+    };
+
+    class counter_block {
+    public:
+        counter_block(counter_site& site, std::atomic<uint64_t>* counters, size_t alternatives) noexcept
+            : site(site), counters(counters), alternatives(alternatives) {
+            site.attach(this);
+        }
+
+        counter_block(counter_block const&) = delete;
+        counter_block& operator=(counter_block const&) = delete;
+
+        ~counter_block() {
+            site.detach(this);
+        }
+
+        void increment(counter_event event, size_t index) noexcept {
+            std::atomic<uint64_t>& counter = counters[index * counter_event_count + static_cast<size_t>(event)];
+            counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+
+        void add_to(alternative_counters* result) const noexcept {
+            for (size_t i = 0; i < alternatives; ++i) {
+                for (size_t event = 0; event < counter_event_count; ++event) {
+                    result[i].events[event] += counters[i * counter_event_count + event].load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+    private:
+        friend class counter_site;
+
+        counter_site& site;
+        std::atomic<uint64_t>* counters;
+        size_t alternatives;
+        counter_block* previous = nullptr;
+        counter_block* next = nullptr;
+    };
+
+    inline void counter_site::attach(counter_block* block) noexcept {
+        std::lock_guard lock(mutex);
+        block->next = blocks;
+        if (blocks != nullptr) {
+            blocks->previous = block;
+        }
+        blocks = block;
+    }
+
+    inline void counter_site::detach(counter_block* block) noexcept {
+        std::lock_guard lock(mutex);
+        block->add_to(retired);
+        (block->previous != nullptr ? block->previous->next : blocks) = block->next;
+        if (block->next != nullptr) {
+            block->next->previous = block->previous;
+        }
+    }
+
+    inline variant_counters counter_site::collect() const {
+        std::lock_guard lock(mutex);
+        variant_counters result{ type, std::vector<alternative_counters>(retired, retired + alternatives) };
+        for (counter_block const* block = blocks; block != nullptr; block = block->next) {
+            block->add_to(result.alternatives.data());
+        }
+        return result;
+    }
+
+    template <size_t Alternatives>
+    struct site_storage {
+        std::array<alternative_counters, Alternatives> retired_storage{};
+    };
+
+    template <size_t Alternatives>
+    struct sized_counter_site : site_storage<Alternatives>, counter_site {
+        explicit sized_counter_site(std::string_view type) noexcept
+            : counter_site(type, this->retired_storage.data(), Alternatives) {}
+    };
+
+    template <size_t Alternatives>
+    struct block_storage {
+        std::array<std::atomic<uint64_t>, Alternatives * counter_event_count> counter_storage{};
+    };
+
+    template <size_t Alternatives>
+    struct sized_counter_block : block_storage<Alternatives>, counter_block {
+        explicit sized_counter_block(counter_site& site) noexcept
+            : counter_block(site, this->counter_storage.data(), Alternatives) {}
+    };
+
+    template <typename Variant>
+    counter_site& site_of() noexcept {
+        static sized_counter_site<variant_size<Variant>::value> site(type_name<Variant>());
+        return site;
+    }
+
+    template <typename Variant>
+    counter_block& local_counters() noexcept {
+        static thread_local sized_counter_block<variant_size<Variant>::value> block(site_of<Variant>());
+        return block;
+    }
+
+    template <typename Variant>
+    constexpr void count_event(counter_event event, size_t index) noexcept {
+        if (!std::is_constant_evaluated()) {
+            local_counters<Variant>().increment(event, index);
+        }
+    }
+
+    inline void write_escaped(std::ostream& out, std::string_view text) {
+        for (char c : text) {
+            if (c == '"' || c == '\\') {
+                out << '\\';
+            }
+            out << c;
+        }
+    }
+
+} // namespace variant_utils
+
+inline counters_snapshot snapshot_counters() {
+    return variant_utils::counter_site::snapshot();
+}
+
+inline void merge_counters(counters_snapshot& into, counters_snapshot const& from) {
+    for (variant_counters const& counters : from) {
+        auto it = std::find_if(into.begin(), into.end(),
+                               [&counters](variant_counters const& other) { return other.type == counters.type; });
+        if (it == into.end()) {
+            into.push_back(counters);
+        }
+        else {
+            *it += counters;
+        }
+    }
+}
+
+inline void dump_counters_text(std::ostream& out, counters_snapshot const& snapshot) {
+    for (variant_counters const& counters : snapshot) {
+        out << counters.type << '\n';
+        for (size_t i = 0; i < counters.alternatives.size(); ++i) {
+            out << "  " << i;
+            for (size_t event = 0; event < variant_utils::counter_event_count; ++event) {
+                out << ' ' << variant_utils::counter_event_names[event] << '=' << counters.alternatives[i].events[event];
+            }
+            out << '\n';
+        }
+    }
+}
+
+inline void dump_counters_json(std::ostream& out, counters_snapshot const& snapshot) {
+    out << '[';
+    for (size_t v = 0; v < snapshot.size(); ++v) {
+        out << (v == 0 ? "\n  " : ",\n  ") << "{\"type\": \"";
+        variant_utils::write_escaped(out, snapshot[v].type);
+        out << "\", \"alternatives\": [";
+        for (size_t i = 0; i < snapshot[v].alternatives.size(); ++i) {
+            out << (i == 0 ? "{" : ", {");
+            for (size_t event = 0; event < variant_utils::counter_event_count; ++event) {
+                out << (event == 0 ? "\"" : ", \"") << variant_utils::counter_event_names[event]
+                    << "\": " << snapshot[v].alternatives[i].events[event];
+            }
+            out << '}';
+        }
+        out << "]}";
+    }
+    out << (snapshot.empty() ? "]\n" : "\n]\n");
+}
@@ -0,0 +1,233 @@
+#pragma once
+#include "variant_algorithm.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+struct parallel_options {
+    size_t thread_count = 0;
+    size_t chunk_size = size_t(1) << 16;
+    size_t sequential_threshold = size_t(1) << 15;
+};
+
+namespace variant_utils {
+
+class thread_pool {
+public:
+    static thread_pool& instance() {
+        static thread_pool pool;
+        return pool;
+    }
+
+    thread_pool(thread_pool const&) = delete;
+    thread_pool& operator=(thread_pool const&) = delete;
+
+    ~thread_pool() {
+        {
+            std::lock_guard lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+    }
+
+    template <typename Job>
+    bool try_run(size_t thread_count, Job const& job) {
+        if (inside_job) {
+            return false;
+        }
+        std::unique_lock submit(submit_mutex, std::try_to_lock);
+        if (!submit.owns_lock()) {
+            return false;
+        }
+        {
+            std::lock_guard lock(mutex);
+            while (threads.size() + 1 < thread_count) {
+                threads.emplace_back([this, worker = threads.size() + 1] { loop(worker); });
+            }
+            context = std::addressof(job);
+            thunk = [](void const* job, size_t worker) { (*static_cast<Job const*>(job))(worker); };
+            active = thread_count - 1;
+            remaining = active;
+            ++generation;
+        }
+        wake.notify_all();
+        inside_job = true;
+        job(size_t(0));
+        inside_job = false;
+        std::unique_lock lock(mutex);
+        done.wait(lock, [this] { return remaining == 0; });
+        return true;
+    }
+
+private:
+    thread_pool() = default;
+
+    void loop(size_t worker) {
+        inside_job = true;
+        size_t seen = 0;
+        std::unique_lock lock(mutex);
+        for (;;) {
+            wake.wait(lock, [this, seen] { return stopping || generation != seen; });
+            if (stopping) {
+                return;
+            }
+            seen = generation;
+            if (worker > active) {
+                continue;
+            }
+            lock.unlock();
+            thunk(context, worker);
+            lock.lock();
+            if (--remaining == 0) {
+                done.notify_one();
+            }
+        }
+    }
+
+    static inline thread_local bool inside_job = false;
+
+    std::mutex submit_mutex;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    std::vector<std::thread> threads;
+    void const* context = nullptr;
+    void (*thunk)(void const*, size_t) = nullptr;
+    size_t active = 0;
+    size_t remaining = 0;
+    size_t generation = 0;
+    bool stopping = false;
+};
+
+class work_stealing_pool {
+public:
+    work_stealing_pool(size_t thread_count, size_t chunk_count) : queues(thread_count) {
+        for (size_t worker = 0; worker < thread_count; ++worker) {
+            size_t first = chunk_count * worker / thread_count;
+            size_t last = chunk_count * (worker + 1) / thread_count;
+            for (size_t chunk = first; chunk < last; ++chunk) {
+                queues[worker].chunks.push_back(chunk);
+            }
+        }
+    }
+
+    template <typename Task>
+    void run(Task const& task) {
+        auto job = [this, &task](size_t worker) { work(task, worker); };
+        if (!thread_pool::instance().try_run(queues.size(), job)) {
+            work(task, 0);
+        }
+#if VARIANT_EXCEPTIONS
+        if (error) {
+            std::rethrow_exception(error);
+        }
+#endif
+    }
+
+private:
+    struct worker_queue {
+        std::mutex mutex;
+        std::deque<size_t> chunks;
+    };
+
+    std::optional<size_t> pop(size_t worker) {
+        std::lock_guard lock(queues[worker].mutex);
+        if (queues[worker].chunks.empty()) {
+            return std::nullopt;
+        }
+        size_t chunk = queues[worker].chunks.front();
+        queues[worker].chunks.pop_front();
+        return chunk;
+    }
+
+    std::optional<size_t> steal(size_t thief) {
+        for (size_t offset = 1; offset < queues.size(); ++offset) {
+            worker_queue& victim = queues[(thief + offset) % queues.size()];
+            std::lock_guard lock(victim.mutex);
+            if (!victim.chunks.empty()) {
+                size_t chunk = victim.chunks.back();
+                victim.chunks.pop_back();
+                return chunk;
+            }
+        }
+        return std::nullopt;
+    }
+
+    template <typename Task>
+    void work(Task const& task, size_t worker) {
+        while (!failed.load(std::memory_order_relaxed)) {
+            std::optional<size_t> chunk = pop(worker);
+            if (!chunk) {
+                chunk = steal(worker);
+            }
+            if (!chunk) {
+                return;
+            }
+#if VARIANT_EXCEPTIONS
+            try {
+                task(*chunk);
+            } catch (...) {
+                std::lock_guard lock(error_mutex);
+                if (!error) {
+                    error = std::current_exception();
+                }
+                failed.store(true, std::memory_order_relaxed);
+            }
+#else
+            task(*chunk);
+#endif
+        }
+    }
+
+    std::vector<worker_queue> queues;
+    std::atomic<bool> failed{ false };
+    std::mutex error_mutex;
+    std::exception_ptr error;
+};
+
+template <typename Function>
+void parallel_chunks(size_t count, parallel_options const& options, Function const& function) {
+    size_t chunk_size = std::max<size_t>(options.chunk_size, 1);
+    size_t chunk_count = (count + chunk_size - 1) / chunk_size;
+    size_t thread_count = options.thread_count ? options.thread_count : std::thread::hardware_concurrency();
+    thread_count = std::max<size_t>(std::min(thread_count, chunk_count), 1);
+    if (count < options.sequential_threshold || thread_count == 1) {
+        function(size_t(0), count);
+        return;
+    }
+    work_stealing_pool(thread_count, chunk_count).run([&function, chunk_size, count](size_t chunk) {
+        size_t first = chunk * chunk_size;
+        function(first, std::min(count, first + chunk_size));
+    });
+}
+
+} // namespace variant_utils
+
+template <std::ranges::contiguous_range Range, typename Visitor>
+void parallel_visit_each(Range&& range, Visitor&& vis, parallel_options const& options = {}) {
+    auto* data = std::ranges::data(range);
+    variant_utils::parallel_chunks(std::ranges::size(range), options, [&vis, data](size_t first, size_t last) {
+        variant_utils::for_each_grouped(data + first, last - first, [&vis, data, first](auto alternative, size_t position) {
+            std::invoke(vis, variant_utils::variant_access::get<alternative>(data[first + position]));
+        });
+    });
+}
+
+template <std::ranges::contiguous_range Range, std::random_access_iterator Out, typename Visitor>
+Out parallel_transform(Range&& range, Out out, Visitor&& vis, parallel_options const& options = {}) {
+    auto* data = std::ranges::data(range);
+    size_t count = std::ranges::size(range);
+    variant_utils::parallel_chunks(count, options, [&vis, data, out](size_t first, size_t last) {
+        variant_utils::for_each_grouped(data + first, last - first, [&vis, data, out, first](auto alternative, size_t position) {
+            out[first + position] = std::invoke(vis, variant_utils::variant_access::get<alternative>(data[first + position]));
+        });
+    });
+    return out + count;
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include "variant.h"
+#include <cstring>
+#include <memory>
+#include <new>
+
+template <typename T>
+T* relocate(T* source, T* dest) noexcept(is_trivially_relocatable_v<T> || std::is_nothrow_move_constructible_v<T>) {
+    if constexpr (is_trivially_relocatable_v<T>) {
+        std::memmove(static_cast<void*>(dest), static_cast<void const*>(source), sizeof(T));
+        return std::launder(dest);
+    }
+    else {
+        T* result = std::construct_at(dest, std::move(*source));
+        std::destroy_at(source);
+        return result;
+    }
+}
+
+template <typename T>
+T* uninitialized_relocate(T* first, T* last, T* out) noexcept(noexcept(relocate(first, out))) {
+    if constexpr (is_trivially_relocatable_v<T>) {
+        size_t count = last - first;
+        if (count != 0) {
+            std::memmove(static_cast<void*>(out), static_cast<void const*>(first), count * sizeof(T));
+        }
+        return out + count;
+    }
+    else {
+        for (; first != last; ++first, ++out) {
+            relocate(first, out);
+        }
+        return out;
+    }
+}
@@ -0,0 +1,611 @@
+#pragma once
+#include "variant.h"
+#include <concepts>
+#include <cstring>
+#include <new>
+#include <ranges>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+template <typename T>
+struct variant_serializer;
+
+template <typename Char, typename Traits, typename Allocator>
+struct variant_serializer<std::basic_string<Char, Traits, Allocator>> {
+    using value_type = std::basic_string<Char, Traits, Allocator>;
+    using view_type = std::basic_string_view<Char, Traits>;
+
+    static size_t size(value_type const& value) noexcept {
+        return value.size() * sizeof(Char);
+    }
+
+    static void write(value_type const& value, std::byte* out) noexcept {
+        if (!value.empty()) {
+            std::memcpy(out, value.data(), size(value));
+        }
+    }
+
+    static view_type view(std::span<std::byte const> bytes) noexcept {
+        return view_type(reinterpret_cast<Char const*>(bytes.data()), bytes.size() / sizeof(Char));
+    }
+
+    static value_type read(std::span<std::byte const> bytes) {
+        if (bytes.size() % sizeof(Char) != 0) {
+            variant_utils::throw_error<std::invalid_argument>("variant deserialization: partial element in payload");
+        }
+        value_type result(bytes.size() / sizeof(Char), Char());
+        std::memcpy(result.data(), bytes.data(), bytes.size());
+        return result;
+    }
+};
+
+template <typename T, typename Allocator>
+    requires std::is_trivially_copyable_v<T>
+struct variant_serializer<std::vector<T, Allocator>> {
+    using value_type = std::vector<T, Allocator>;
+    using view_type = std::span<T const>;
+
+    static size_t size(value_type const& value) noexcept {
+        return value.size() * sizeof(T);
+    }
+
+    static void write(value_type const& value, std::byte* out) noexcept {
+        if (!value.empty()) {
+            std::memcpy(out, value.data(), size(value));
+        }
+    }
+
+    static view_type view(std::span<std::byte const> bytes) noexcept {
+        return view_type(reinterpret_cast<T const*>(bytes.data()), bytes.size() / sizeof(T));
+    }
+
+    static value_type read(std::span<std::byte const> bytes) {
+        if (bytes.size() % sizeof(T) != 0) {
+            variant_utils::throw_error<std::invalid_argument>("variant deserialization: partial element in payload");
+        }
+        value_type result(bytes.size() / sizeof(T));
+        if (!result.empty()) {
+            std::memcpy(result.data(), bytes.data(), bytes.size());
+        }
+        return result;
+    }
+};
+
+namespace variant_utils {
+
+    template <typename T>
+    concept raw_serializable = std::is_trivially_copyable_v<T>;
+
+    template <typename T>
+    concept custom_serializable = !raw_serializable<T> && requires(T const& value, std::byte* out,
+                                                                   std::span<std::byte const> bytes) {
+        { variant_serializer<T>::size(value) } -> std::convertible_to<size_t>;
+        variant_serializer<T>::write(value, out);
+        { variant_serializer<T>::read(bytes) } -> std::convertible_to<T>;
+    };
+
+    template <typename T>
+    concept serializable = raw_serializable<T> || custom_serializable<T>;
+
+    template <typename T>
+    concept viewable = custom_serializable<T> && requires(std::span<std::byte const> bytes) {
+        variant_serializer<T>::view(bytes);
+    };
+
+    using length_type = uint32_t;
+
+    constexpr size_t align_up(size_t value, size_t alignment) noexcept {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    template <serializable T>
+    size_t payload_size(T const& value) {
+        if constexpr (raw_serializable<T>) {
+            return sizeof(T);
+        }
+        else {
+            size_t size = variant_serializer<T>::size(value);
+            if (size > std::numeric_limits<length_type>::max()) {
+                variant_utils::throw_error<std::length_error>("variant serialization: payload is too large");
+            }
+            return sizeof(length_type) + size;
+        }
+    }
+
+    template <serializable T>
+    std::byte* write_payload(T const& value, std::byte* out) {
+        if constexpr (raw_serializable<T>) {
+            std::memcpy(out, std::addressof(value), sizeof(T));
+            return out + sizeof(T);
+        }
+        else {
+            length_type length = static_cast<length_type>(variant_serializer<T>::size(value));
+            std::memcpy(out, &length, sizeof(length));
+            variant_serializer<T>::write(value, out + sizeof(length));
+            return out + sizeof(length) + length;
+        }
+    }
+
+    template <size_t Index, typename... Types>
+    void emplace_payload(variant<Types...>& v, std::span<std::byte const> bytes) {
+        using T = variant_alternative_t<Index, variant<Types...>>;
+        if constexpr (raw_serializable<T>) {
+            alignas(T) std::byte buffer[sizeof(T)];
+            std::memcpy(buffer, bytes.data(), sizeof(T));
+            v.template emplace<Index>(*std::launder(reinterpret_cast<T*>(buffer)));
+        }
+        else {
+            v.template emplace<Index>(variant_serializer<T>::read(bytes));
+        }
+    }
+
+    struct array_header {
+        char magic[4];
+        uint32_t alternatives;
+        uint64_t count;
+        uint64_t tags_offset;
+        uint64_t slots_offset;
+    };
+
+    struct column_header {
+        uint64_t offset;
+        uint64_t count;
+        uint64_t bytes;
+    };
+
+    struct blob_range {
+        uint64_t first;
+        uint64_t last;
+    };
+
+    inline constexpr char array_magic[4] = { 'V', 'A', 'R', 'C' };
+    inline constexpr size_t column_alignment = 64;
+    inline constexpr size_t element_alignment = 8;
+
+    template <typename Variant>
+    struct array_writer;
+
+    template <typename... Types>
+    struct array_writer<variant<Types...>> {
+        using tag_type = index_type_t<sizeof...(Types)>;
+        using slot_type = uint32_t;
+
+        static std::vector<std::byte> write(variant<Types...> const* data, size_t count) {
+            std::array<column_header, sizeof...(Types)> columns{};
+            std::array<size_t, sizeof...(Types)> blobs{};
+            for (size_t i = 0; i < count; ++i) {
+                variant_utils::check_access(!data[i].valueless_by_exception());
+                visit_index<void>(
+                    [&columns, &blobs, &data, i](auto index) {
+                        using T = type_at_t<index, Types...>;
+                        ++columns[index].count;
+                        if constexpr (custom_serializable<T>) {
+                            blobs[index] += align_up(variant_serializer<T>::size(variant_access::get<index>(data[i])),
+                                                     element_alignment);
+                        }
+                    },
+                    data[i]);
+            }
+
+            size_t offset = sizeof(array_header) + sizeof(columns);
+            size_t tags_offset = align_up(offset, column_alignment);
+            size_t slots_offset = align_up(tags_offset + count * sizeof(tag_type), column_alignment);
+            offset = slots_offset + count * sizeof(slot_type);
+            [&]<size_t... Indexes>(std::index_sequence<Indexes...>) {
+                ((columns[Indexes].offset = align_up(offset, column_alignment),
+                  columns[Indexes].bytes = column_bytes<Indexes>(columns[Indexes].count, blobs[Indexes]),
+                  offset = columns[Indexes].offset + columns[Indexes].bytes),
+                 ...);
+            }(std::index_sequence_for<Types...>());
+            for (column_header const& column : columns) {
+                if (column.count > std::numeric_limits<slot_type>::max()) {
+                    variant_utils::throw_error<std::length_error>("variant serialization: alternative column is too large");
+                }
+            }
+
+            std::vector<std::byte> result(offset);
+            std::byte* base = result.data();
+            array_header header{ {}, sizeof...(Types), count, tags_offset, slots_offset };
+            std::memcpy(header.magic, array_magic, sizeof(array_magic));
+            std::memcpy(base, &header, sizeof(header));
+            std::memcpy(base + sizeof(header), columns.data(), sizeof(columns));
+
+            std::array<size_t, sizeof...(Types)> filled{};
+            std::array<size_t, sizeof...(Types)> blob_filled{};
+            for (size_t i = 0; i < count; ++i) {
+                visit_index<void>(
+                    [&](auto index) {
+                        using T = type_at_t<index, Types...>;
+                        tag_type tag = static_cast<tag_type>(index);
+                        slot_type slot = static_cast<slot_type>(filled[index]++);
+                        std::memcpy(base + tags_offset + i * sizeof(tag_type), &tag, sizeof(tag));
+                        std::memcpy(base + slots_offset + i * sizeof(slot_type), &slot, sizeof(slot));
+                        std::byte* column = base + columns[index].offset;
+                        T const& value = variant_access::get<index>(data[i]);
+                        if constexpr (raw_serializable<T>) {
+                            std::memcpy(column + slot * sizeof(T), std::addressof(value), sizeof(T));
+                        }
+                        else {
+                            std::byte* blob = column + columns[index].count * sizeof(blob_range);
+                            blob_range range{ blob_filled[index], blob_filled[index] + variant_serializer<T>::size(value) };
+                            variant_serializer<T>::write(value, blob + range.first);
+                            std::memcpy(column + slot * sizeof(blob_range), &range, sizeof(range));
+                            blob_filled[index] = align_up(range.last, element_alignment);
+                        }
+                    },
+                    data[i]);
+            }
+            return result;
+        }
+
+        template <size_t Index>
+        static size_t column_bytes(size_t count, size_t blob) noexcept {
+            if constexpr (raw_serializable<type_at_t<Index, Types...>>) {
+                return count * sizeof(type_at_t<Index, Types...>);
+            }
+            else {
+                return count * sizeof(blob_range) + blob;
+            }
+        }
+    };
+
+} // namespace variant_utils
+
+template <typename... Types>
+    requires(variant_utils::serializable<Types> && ...)
+size_t serialized_size(variant<Types...> const& v) {
+    variant_utils::check_access(!v.valueless_by_exception());
+    return sizeof(variant_utils::index_type_t<sizeof...(Types)>) +
+           variant_utils::visit_index<size_t>(
+               [&v](auto index) { return variant_utils::payload_size(variant_utils::variant_access::get<index>(v)); },
+               v);
+}
+
+template <typename... Types>
+    requires(variant_utils::serializable<Types> && ...)
+std::byte* serialize(variant<Types...> const& v, std::byte* out) {
+    variant_utils::check_access(!v.valueless_by_exception());
+    auto tag = static_cast<variant_utils::index_type_t<sizeof...(Types)>>(v.index());
+    std::memcpy(out, &tag, sizeof(tag));
+    return variant_utils::visit_index<std::byte*>(
+        [&v, out = out + sizeof(tag)](auto index) {
+            return variant_utils::write_payload(variant_utils::variant_access::get<index>(v), out);
+        },
+        v);
+}
+
+template <typename... Types>
+    requires(variant_utils::serializable<Types> && ...)
+std::byte const* deserialize(std::span<std::byte const> in, variant<Types...>& v) {
+    using tag_type = variant_utils::index_type_t<sizeof...(Types)>;
+    tag_type tag;
+    if (in.size() < sizeof(tag)) {
+        variant_utils::throw_error<std::out_of_range>("variant deserialization: truncated input");
+    }
+    std::memcpy(&tag, in.data(), sizeof(tag));
+    if (tag >= sizeof...(Types)) {
+        variant_utils::throw_error<std::invalid_argument>("variant deserialization: invalid alternative index");
+    }
+    std::span<std::byte const> payload = in.subspan(sizeof(tag));
+    return variant_utils::visit_index<std::byte const*>(
+        [&v, payload](auto index) {
+            using T = variant_alternative_t<index, variant<Types...>>;
+            size_t offset = 0;
+            size_t size = sizeof(T);
+            if constexpr (variant_utils::custom_serializable<T>) {
+                variant_utils::length_type length;
+                if (payload.size() < sizeof(length)) {
+                    variant_utils::throw_error<std::out_of_range>("variant deserialization: truncated input");
+                }
+                std::memcpy(&length, payload.data(), sizeof(length));
+                offset = sizeof(length);
+                size = length;
+            }
+            if (payload.size() - offset < size) {
+                variant_utils::throw_error<std::out_of_range>("variant deserialization: truncated input");
+            }
+            variant_utils::emplace_payload<index>(v, payload.subspan(offset, size));
+            return payload.data() + offset + size;
+        },
+        variant_utils::index_holder<sizeof...(Types)>{ tag });
+}
+
+template <std::ranges::contiguous_range Range>
+std::vector<std::byte> serialize_array(Range&& range) {
+    return variant_utils::array_writer<std::ranges::range_value_t<Range>>::write(std::ranges::data(range),
+                                                                                 std::ranges::size(range));
+}
+
+template <typename... Types>
+    requires(variant_utils::serializable<Types> && ...)
+class variant_array_view {
+    template <size_t Index>
+    using alternative_type = variant_alternative_t<Index, variant<Types...>>;
+
+    using tag_type = variant_utils::index_type_t<sizeof...(Types)>;
+    using slot_type = uint32_t;
+
+public:
+    using value_type = variant<Types...>;
+
+    explicit variant_array_view(std::span<std::byte const> bytes) : bytes(bytes) {
+        variant_utils::array_header header;
+        if (bytes.size() < sizeof(header) + sizeof(columns)) {
+            variant_utils::throw_error<std::invalid_argument>("variant_array_view: truncated header");
+        }
+        std::memcpy(&header, bytes.data(), sizeof(header));
+        std::memcpy(columns.data(), bytes.data() + sizeof(header), sizeof(columns));
+        if (std::memcmp(header.magic, variant_utils::array_magic, sizeof(header.magic)) != 0 ||
+            header.alternatives != sizeof...(Types)) {
+            variant_utils::throw_error<std::invalid_argument>("variant_array_view: not a variant array of this type");
+        }
+        if (reinterpret_cast<uintptr_t>(bytes.data()) % required_alignment != 0) {
+            variant_utils::throw_error<std::invalid_argument>("variant_array_view: misaligned buffer");
+        }
+        count = header.count;
+        tags = check_array<tag_type>(header.tags_offset, count);
+        slots = check_array<slot_type>(header.slots_offset, count);
+        [this]<size_t... Indexes>(std::index_sequence<Indexes...>) {
+            (check_column<Indexes>(), ...);
+        }(std::index_sequence_for<Types...>());
+    }
+
+    size_t size() const noexcept {
+        return count;
+    }
+
+    bool empty() const noexcept {
+        return count == 0;
+    }
+
+    size_t index(size_t position) const noexcept {
+        return tags[position];
+    }
+
+    std::span<tag_type const> indexes() const noexcept {
+        return { tags, count };
+    }
+
+    template <size_t Index>
+        requires variant_utils::raw_serializable<alternative_type<Index>>
+    std::span<alternative_type<Index> const> alternative() const noexcept {
+        return { reinterpret_cast<alternative_type<Index> const*>(bytes.data() + columns[Index].offset),
+                 columns[Index].count };
+    }
+
+    template <size_t Index>
+    decltype(auto) get(size_t position) const {
+        variant_utils::check_access(index(position) == Index);
+        return element<Index>(slots[position]);
+    }
+
+    template <typename Visitor>
+    decltype(auto) visit(size_t position, Visitor&& vis) const {
+        return dispatch(
+            [this, &vis, position](auto index) -> decltype(auto) {
+                return std::forward<Visitor>(vis)(element<index>(slots[position]));
+            },
+            position);
+    }
+
+    value_type load(size_t position) const {
+        return dispatch(
+            [this, position](auto index) {
+                if constexpr (variant_utils::raw_serializable<alternative_type<index>>) {
+                    return value_type(in_place_index<index>, element<index>(slots[position]));
+                }
+                else {
+                    return value_type(in_place_index<index>,
+                                      variant_serializer<alternative_type<index>>::read(blob<index>(slots[position])));
+                }
+            },
+            position);
+    }
+
+private:
+    static constexpr size_t required_alignment = std::max({ alignof(uint64_t), alignof(Types)... });
+
+    template <typename Visitor>
+    decltype(auto) dispatch(Visitor&& vis, size_t position) const {
+        if (tags[position] >= sizeof...(Types)) {
+            variant_utils::throw_error<std::invalid_argument>("variant_array_view: invalid alternative index");
+        }
+        using R = decltype(std::forward<Visitor>(vis)(variant_utils::index_wrapper<0>{}));
+        return variant_utils::visit_index<R>(std::forward<Visitor>(vis),
+                                             variant_utils::index_holder<sizeof...(Types)>{ tags[position] });
+    }
+
+    void check_range(uint64_t offset, uint64_t size) const {
+        if (offset > bytes.size() || size > bytes.size() - offset) {
+            variant_utils::throw_error<std::invalid_argument>("variant_array_view: column out of range");
+        }
+    }
+
+    template <typename T>
+    T const* check_array(uint64_t offset, uint64_t size) const {
+        if (offset > bytes.size() || size > (bytes.size() - offset) / sizeof(T)) {
+            variant_utils::throw_error<std::invalid_argument>("variant_array_view: column out of range");
+        }
+        if (offset % alignof(T) != 0) {
+            variant_utils::throw_error<std::invalid_argument>("variant_array_view: misaligned column");
+        }
+        return reinterpret_cast<T const*>(bytes.data() + offset);
+    }
+
+    template <size_t Index>
+    void check_column() const {
+        variant_utils::column_header const& column = columns[Index];
+        check_range(column.offset, column.bytes);
+        if constexpr (variant_utils::raw_serializable<alternative_type<Index>>) {
+            check_array<alternative_type<Index>>(column.offset, column.count);
+            if (column.bytes != column.count * sizeof(alternative_type<Index>)) {
+                variant_utils::throw_error<std::invalid_argument>("variant_array_view: column size mismatch");
+            }
+        }
+        else {
+            check_array<variant_utils::blob_range>(column.offset, column.count);
+            if (column.bytes < column.count * sizeof(variant_utils::blob_range)) {
+                variant_utils::throw_error<std::invalid_argument>("variant_array_view: column size mismatch");
+            }
+        }
+    }
+
+    template <size_t Index>
+    decltype(auto) element(size_t slot) const {
+        using T = alternative_type<Index>;
+        if (slot >= columns[Index].count) {
+            variant_utils::throw_error<std::out_of_range>("variant_array_view: slot out of range");
+        }
+        if constexpr (variant_utils::raw_serializable<T>) {
+            return *reinterpret_cast<T const*>(bytes.data() + columns[Index].offset + slot * sizeof(T));
+        }
+        else if constexpr (variant_utils::viewable<T>) {
+            return variant_serializer<T>::view(blob<Index>(slot));
+        }
+        else {
+            return blob<Index>(slot);
+        }
+    }
+
+    template <size_t Index>
+    std::span<std::byte const> blob(size_t slot) const {
+        variant_utils::column_header const& column = columns[Index];
+        auto const& range = reinterpret_cast<variant_utils::blob_range const*>(bytes.data() + column.offset)[slot];
+        size_t table = column.count * sizeof(variant_utils::blob_range);
+        if (range.first > range.last || range.last > column.bytes - table ||
+            range.first % variant_utils::element_alignment != 0) {
+            variant_utils::throw_error<std::invalid_argument>("variant_array_view: element out of range");
+        }
+        return bytes.subspan(column.offset + table + range.first, range.last - range.first);
+    }
+
+    std::span<std::byte const> bytes;
+    std::array<variant_utils::column_header, sizeof...(Types)> columns{};
+    size_t count = 0;
+    tag_type const* tags = nullptr;
+    slot_type const* slots = nullptr;
+};
+
+enum class decode_status { need_more, complete, invalid };
+
+template <typename... Types>
+    requires(variant_utils::serializable<Types> && ...)
+class variant_decoder {
+public:
+    struct result {
+        decode_status status;
+        size_t consumed;
+    };
+
+    explicit variant_decoder(size_t max_payload = std::numeric_limits<variant_utils::length_type>::max()) noexcept
+        : max_payload(max_payload) {}
+
+    result feed(std::span<std::byte const> input, variant<Types...>& out) {
+        size_t consumed = 0;
+        while (true) {
+            switch (state) {
+            case phase::tag:
+                if (!fill(input, consumed, sizeof(tag))) {
+                    return { decode_status::need_more, consumed };
+                }
+                std::memcpy(&tag, buffer.data(), sizeof(tag));
+                if (tag >= sizeof...(Types)) {
+                    state = phase::invalid;
+                    break;
+                }
+                start(custom[tag] ? phase::length : phase::payload, custom[tag] ? sizeof(length) : fixed[tag]);
+                break;
+            case phase::length:
+                if (!fill(input, consumed, sizeof(length))) {
+                    return { decode_status::need_more, consumed };
+                }
+                std::memcpy(&length, buffer.data(), sizeof(length));
+                if (length > max_payload) {
+                    state = phase::invalid;
+                    break;
+                }
+                start(phase::payload, length);
+                break;
+            case phase::payload:
+                if (filled == 0 && input.size() - consumed >= expected) {
+                    consumed += expected;
+                    finish(input.subspan(consumed - expected, expected), out);
+                    return { decode_status::complete, consumed };
+                }
+                if (custom[tag]) {
+                    heap.resize(expected);
+                    size_t chunk = std::min(expected - filled, input.size() - consumed);
+                    if (chunk != 0) {
+                        std::memcpy(heap.data() + filled, input.data() + consumed, chunk);
+                    }
+                    filled += chunk;
+                    consumed += chunk;
+                    if (filled < expected) {
+                        return { decode_status::need_more, consumed };
+                    }
+                    finish(heap, out);
+                }
+                else {
+                    if (!fill(input, consumed, expected)) {
+                        return { decode_status::need_more, consumed };
+                    }
+                    finish(std::span<std::byte const>(buffer.data(), expected), out);
+                }
+                return { decode_status::complete, consumed };
+            case phase::invalid:
+                return { decode_status::invalid, consumed };
+            }
+        }
+    }
+
+    void reset() noexcept {
+        start(phase::tag, 0);
+    }
+
+private:
+    using tag_type = variant_utils::index_type_t<sizeof...(Types)>;
+
+    enum class phase { tag, length, payload, invalid };
+
+    static constexpr std::array<bool, sizeof...(Types)> custom = { variant_utils::custom_serializable<Types>... };
+    static constexpr std::array<size_t, sizeof...(Types)> fixed = {
+        (variant_utils::raw_serializable<Types> ? sizeof(Types) : 0)...
+    };
+    static constexpr size_t buffer_size =
+        std::max({ sizeof(tag_type), sizeof(variant_utils::length_type),
+                   (variant_utils::raw_serializable<Types> ? sizeof(Types) : 0)... });
+
+    bool fill(std::span<std::byte const> input, size_t& consumed, size_t size) noexcept {
+        size_t chunk = std::min(size - filled, input.size() - consumed);
+        if (chunk != 0) {
+            std::memcpy(buffer.data() + filled, input.data() + consumed, chunk);
+        }
+        filled += chunk;
+        consumed += chunk;
+        return filled == size;
+    }
+
+    void start(phase next, size_t size) noexcept {
+        state = next;
+        filled = 0;
+        expected = size;
+    }
+
+    void finish(std::span<std::byte const> payload, variant<Types...>& out) {
+        reset();
+        variant_utils::visit_index<void>([&out, payload](auto index) { variant_utils::emplace_payload<index>(out, payload); },
+                                         variant_utils::index_holder<sizeof...(Types)>{ tag });
+    }
+
+    phase state = phase::tag;
+    tag_type tag = 0;
+    variant_utils::length_type length = 0;
+    size_t filled = 0;
+    size_t expected = 0;
+    size_t max_payload;
+    alignas(std::max_align_t) std::array<std::byte, buffer_size> buffer;
+    std::vector<std::byte> heap;
+};
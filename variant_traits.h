@@ -39,6 +39,9 @@ template <typename... Types>
 concept trivial_move_assign =
 trivial_dtor<Types...> && trivial_move_ctor<Types...> && (std::is_trivially_move_assignable_v<Types> && ...);
 
+template <typename... Types>
+concept trivial_swap = (is_trivially_relocatable_v<Types> && ...);
+
 template <typename... Types>
 concept nothrow_default_ctor =
 std::is_nothrow_default_constructible_v<typename std::tuple_element<0, std::tuple<Types...>>::type>;
@@ -52,17 +55,23 @@ concept nothrow_move_ctor = (std::is_nothrow_move_constructible_v<Types> && ...)
 template <typename... Types>
 concept nothrow_copy_assign = false;
 
+template <typename... Types>
+concept never_valueless = nothrow_move_ctor<Types...> || enable_never_valueless<variant<Types...>>::value;
+
 template <typename... Types>
 concept nothrow_move_assign = nothrow_move_ctor<Types...> && (std::is_nothrow_move_assignable_v<Types> && ...);
 
 template <typename T, typename... Types>
-concept nothrow_convert_ctor =
-std::is_nothrow_constructible_v<variant_alternative_t<index_chooser_v<T, Types...>, variant<Types...>>, T>;
+concept nothrow_convert_ctor = std::is_nothrow_constructible_v<find_overload_t<T, Types...>, T>;
 
 template <typename T, typename... Types>
 concept nothrow_convert_assign =
-nothrow_convert_ctor<T, Types...> &&
-std::is_nothrow_assignable_v<variant_alternative_t<index_chooser_v<T, Types...>, variant<Types...>>, T>;
+nothrow_convert_ctor<T, Types...> && std::is_nothrow_assignable_v<find_overload_t<T, Types...>&, T>;
+
+template <typename T, typename Alloc, typename... Args>
+concept uses_allocator_ctor = std::is_constructible_v<T, Args...> ||
+                              std::is_constructible_v<T, std::allocator_arg_t, Alloc const&, Args...> ||
+                              std::is_constructible_v<T, Args..., Alloc const&>;
 
 template <typename T, typename... Types>
 inline constexpr bool exactly_once_v = (std::is_same_v<T, Types> +...) == 1;
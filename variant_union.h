@@ -3,89 +3,164 @@
 
 namespace variant_utils {
 
-template <typename... Rest>
-union variant_union {};
+template <typename... Types>
+union variant_union;
 
-template <typename First, typename... Rest>
-union variant_union<First, Rest...> {
+template <size_t Offset, typename Indexes, typename... Types>
+struct union_slice;
 
-    constexpr variant_union() : rest() {}
+template <size_t Offset, size_t... Indexes, typename... Types>
+struct union_slice<Offset, std::index_sequence<Indexes...>, Types...> {
+    using type = variant_union<type_at_t<Offset + Indexes, Types...>...>;
+};
 
-    template <size_t Index, typename... Args>
-    constexpr variant_union(in_place_index_t<Index>, Args&&... args)
-        : rest(in_place_index<Index - 1>, std::forward<Args>(args)...) {}
+template <size_t Offset, size_t Count, typename... Types>
+using union_slice_t = typename union_slice<Offset, std::make_index_sequence<Count>, Types...>::type;
+
+template <>
+union variant_union<> {};
+
+template <typename First>
+union variant_union<First> {
+
+    constexpr variant_union() : empty() {}
 
     template <typename... Args>
     constexpr variant_union(in_place_index_t<0>, Args&&... args) : first(std::forward<Args>(args)...) {}
 
     template <size_t Index>
-    void construct(variant_union const& other) {
-        if constexpr (Index == 0) {
-            std::construct_at(std::addressof(first), other.first);
+    constexpr void construct(variant_union const& other) {
+        std::construct_at(std::addressof(first), other.first);
+    }
+
+    template <size_t Index>
+    constexpr void construct(variant_union&& other) {
+        std::construct_at(std::addressof(first), std::move(other.first));
+    }
+
+    template <size_t Index>
+    constexpr void reset() {
+        std::destroy_at(std::addressof(first));
+    }
+
+    template <size_t Index, typename... Args>
+    constexpr auto& emplace(in_place_index_t<Index>, Args&&... args) {
+        std::construct_at(std::addressof(first), std::forward<Args>(args)...);
+        return first;
+    }
+
+    template <size_t Index>
+    constexpr auto& get(in_place_index_t<Index>) {
+        return first;
+    }
+
+    template <size_t Index>
+    constexpr auto const& get(in_place_index_t<Index>) const {
+        return first;
+    }
+
+    constexpr ~variant_union()
+        requires(!variant_utils::trivial_dtor<First>) {};
+    constexpr ~variant_union()
+        requires(variant_utils::trivial_dtor<First>) = default;
+
+private:
+    variant_union<> empty;
+    First first;
+};
+
+template <typename... Types>
+union variant_union {
+
+    static constexpr size_t half = sizeof...(Types) / 2;
+    using left_union = union_slice_t<0, half, Types...>;
+    using right_union = union_slice_t<half, sizeof...(Types) - half, Types...>;
+
+    constexpr variant_union() : left() {}
+
+    template <size_t Index, typename... Args>
+        requires(Index < half)
+    constexpr variant_union(in_place_index_t<Index>, Args&&... args)
+        : left(in_place_index<Index>, std::forward<Args>(args)...) {}
+
+    template <size_t Index, typename... Args>
+        requires(Index >= half)
+    constexpr variant_union(in_place_index_t<Index>, Args&&... args)
+        : right(in_place_index<Index - half>, std::forward<Args>(args)...) {}
+
+    template <size_t Index>
+    constexpr void construct(variant_union const& other) {
+        if constexpr (Index < half) {
+            std::construct_at(std::addressof(left));
+            left.template construct<Index>(other.left);
         }
         else {
-            rest.template construct<Index - 1>(other.rest);
+            std::construct_at(std::addressof(right));
+            right.template construct<Index - half>(other.right);
         }
     }
 
     template <size_t Index>
-    void construct(variant_union&& other) {
-        if constexpr (Index == 0) {
-            std::construct_at(std::addressof(first), std::move(other.first));
+    constexpr void construct(variant_union&& other) {
+        if constexpr (Index < half) {
+            std::construct_at(std::addressof(left));
+            left.template construct<Index>(std::move(other.left));
         }
         else {
-            rest.template construct<Index - 1>(std::move(other.rest));
+            std::construct_at(std::addressof(right));
+            right.template construct<Index - half>(std::move(other.right));
         }
     }
 
     template <size_t Index>
-    void reset() {
-        if constexpr (Index == 0) {
-            first.~First();
+    constexpr void reset() {
+        if constexpr (Index < half) {
+            left.template reset<Index>();
         }
         else {
-            rest.template reset<Index - 1>();
+            right.template reset<Index - half>();
         }
     }
 
     template <size_t Index, typename... Args>
-    decltype(auto) emplace(in_place_index_t<Index>, Args&&... args) {
-        if constexpr (Index == 0) {
-            std::construct_at(std::addressof(first), std::forward<Args>(args)...);
-            return this->get(in_place_index<0>);
+    constexpr auto& emplace(in_place_index_t<Index>, Args&&... args) {
+        if constexpr (Index < half) {
+            std::construct_at(std::addressof(left));
+            return left.emplace(in_place_index<Index>, std::forward<Args>(args)...);
         }
         else {
-            return rest.template emplace<Index - 1>(in_place_index<Index - 1>, std::forward<Args>(args)...);
+            std::construct_at(std::addressof(right));
+            return right.emplace(in_place_index<Index - half>, std::forward<Args>(args)...);
         }
     }
 
     template <size_t Index>
     constexpr auto& get(in_place_index_t<Index>) {
-        if constexpr (Index == 0) {
-            return first;
+        if constexpr (Index < half) {
+            return left.get(in_place_index<Index>);
         }
         else {
-            return rest.get(in_place_index<Index - 1>);
+            return right.get(in_place_index<Index - half>);
         }
     }
 
     template <size_t Index>
     constexpr auto const& get(in_place_index_t<Index>) const {
-        if constexpr (Index == 0) {
-            return first;
+        if constexpr (Index < half) {
+            return left.get(in_place_index<Index>);
         }
         else {
-            return rest.get(in_place_index<Index - 1>);
+            return right.get(in_place_index<Index - half>);
         }
     }
 
     constexpr ~variant_union()
-        requires(!variant_utils::trivial_dtor<First, Rest...>) {};
+        requires(!variant_utils::trivial_dtor<Types...>) {};
     constexpr ~variant_union()
-        requires(variant_utils::trivial_dtor<First, Rest...>) = default;
+        requires(variant_utils::trivial_dtor<Types...>) = default;
 
 private:
-    First first;
-    variant_union<Rest...> rest;
+    left_union left;
+    right_union right;
 };
-}
\ No newline at end of file
+}
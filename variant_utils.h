@@ -2,8 +2,18 @@
 
 #include "variant.h"
 #include <array>
+#include <cassert>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <exception>
 #include <functional>
+#include <limits>
+
+#ifdef VARIANT_INSTRUMENTATION
+#include "variant_instrumentation.h"
+#endif
 
 template <typename... Args>
 class variant;
@@ -32,6 +42,38 @@ struct variant_size<variant<Types...>> : std::integral_constant<size_t, sizeof..
 template <typename Variant>
 inline constexpr size_t variant_size_v = variant_size<Variant>::value;
 
+// NEVER VALUELESS
+
+template <typename Variant>
+struct enable_never_valueless : std::false_type {};
+
+// HOT ALTERNATIVES
+
+template <typename Variant>
+struct hot_alternatives {
+    using type = std::index_sequence<>;
+};
+
+// INSTRUMENTATION
+
+#ifdef VARIANT_INSTRUMENTATION
+#define VARIANT_COUNT(Variant, event, index)                                                                           \
+    ::variant_utils::count_event<Variant>(::variant_utils::counter_event::event, index)
+#else
+#define VARIANT_COUNT(Variant, event, index) static_cast<void>(sizeof(index))
+#endif
+
+// TRIVIAL RELOCATION
+
+template <typename T>
+struct is_trivially_relocatable : std::is_trivially_copyable<T> {};
+
+template <typename... Types>
+struct is_trivially_relocatable<variant<Types...>> : std::conjunction<is_trivially_relocatable<Types>...> {};
+
+template <typename T>
+inline constexpr bool is_trivially_relocatable_v = is_trivially_relocatable<T>::value;
+
 // bad_variant_access
 
 class bad_variant_access : public std::exception {
@@ -43,10 +85,86 @@ public:
     }
 };
 
+// ERROR POLICY
+
+#define VARIANT_ERROR_THROW 0
+#define VARIANT_ERROR_ABORT 1
+#define VARIANT_ERROR_UNCHECKED 2
+
+#if defined(__cpp_exceptions) || defined(__EXCEPTIONS) || defined(_CPPUNWIND)
+#define VARIANT_EXCEPTIONS 1
+#else
+#define VARIANT_EXCEPTIONS 0
+#endif
+
+#ifndef VARIANT_ERROR_POLICY
+#if VARIANT_EXCEPTIONS
+#define VARIANT_ERROR_POLICY VARIANT_ERROR_THROW
+#else
+#define VARIANT_ERROR_POLICY VARIANT_ERROR_ABORT
+#endif
+#endif
+
+#if VARIANT_ERROR_POLICY == VARIANT_ERROR_THROW && !VARIANT_EXCEPTIONS
+#error "VARIANT_ERROR_THROW requires exceptions"
+#endif
+
+namespace variant_utils {
+
+    [[noreturn]] inline void fail(char const* message) noexcept {
+        std::fprintf(stderr, "%s\n", message);
+        std::abort();
+    }
+
+    template <typename Exception>
+    [[noreturn]] void throw_error(char const* message) {
+#if VARIANT_EXCEPTIONS
+        throw Exception(message);
+#else
+        fail(message);
+#endif
+    }
+
+    [[noreturn]] inline void throw_bad_variant_access() {
+#if VARIANT_ERROR_POLICY == VARIANT_ERROR_THROW
+        throw bad_variant_access();
+#else
+        fail("bad variant access");
+#endif
+    }
+
+    constexpr void check_access([[maybe_unused]] bool valid) {
+#if VARIANT_ERROR_POLICY == VARIANT_ERROR_UNCHECKED
+        assert(valid && "bad variant access");
+#else
+        if (!valid) [[unlikely]] {
+            throw_bad_variant_access();
+        }
+#endif
+    }
+
+} // namespace variant_utils
+
 // indexes
 
 inline constexpr size_t variant_npos = -1;
 
+namespace variant_utils {
+
+    template <size_t Size>
+    struct index_type_for {
+        static_assert(Size < 65535, "variant supports at most 65534 alternatives");
+        using type = std::conditional_t<(Size < 255), uint8_t, uint16_t>;
+    };
+
+    template <size_t Size>
+    using index_type_t = typename index_type_for<Size>::type;
+
+    template <size_t Size>
+    inline constexpr index_type_t<Size> index_npos_v = std::numeric_limits<index_type_t<Size>>::max();
+
+} // namespace variant_utils
+
 template <size_t T>
 class in_place_index_t {
 public:
@@ -68,15 +186,34 @@ struct monostate {};
 
 // VARIANT ALTERNATIVE
 
+namespace variant_utils {
+
+    template <size_t Index, typename T>
+    struct indexed_type {
+        using type = T;
+    };
+
+    template <typename Indexes, typename... Types>
+    struct indexed_types;
+
+    template <size_t... Indexes, typename... Types>
+    struct indexed_types<std::index_sequence<Indexes...>, Types...> : indexed_type<Indexes, Types>... {};
+
+    template <size_t Index, typename T>
+    indexed_type<Index, T> select_type(indexed_type<Index, T> const&);
+
+    template <size_t Index, typename... Types>
+    using type_at_t = typename decltype(select_type<Index>(
+        std::declval<indexed_types<std::index_sequence_for<Types...>, Types...>>()))::type;
+
+} // namespace variant_utils
+
 template <size_t Index, typename Variant>
 struct variant_alternative;
 
-template <size_t Index, typename First, typename... Rest>
-struct variant_alternative<Index, variant<First, Rest...>> : variant_alternative<Index - 1, variant<Rest...>> {};
-
-template <typename First, typename... Rest>
-struct variant_alternative<0, variant<First, Rest...>> {
-    using type = First;
+template <size_t Index, typename... Types>
+struct variant_alternative<Index, variant<Types...>> {
+    using type = variant_utils::type_at_t<Index, Types...>;
 };
 
 template <size_t Index, typename Variant>
@@ -125,28 +262,49 @@ namespace variant_utils {
     };
 
     template <typename T, typename... Types>
-    using find_overload_t = typename std::invoke_result_t<find_overload<T, std::index_sequence_for<Types...>, Types...>, T>;
+    concept exact_overload = ((std::is_same_v<std::remove_cv_t<Types>, std::decay_t<T>> + ... + 0) == 1) &&
+                             (std::is_same_v<Types, std::decay_t<T>> || ...) &&
+                             requires { arr<std::decay_t<T>>{ { std::declval<T>() } }; };
 
-    template <bool is_same, typename CurrentType, typename... Types>
-    struct index_chooser {
-        static constexpr size_t Index = 0;
-    };
+    template <typename T, typename... Types>
+    using find_overload_t =
+        typename std::conditional_t<exact_overload<T, Types...>, std::type_identity<std::decay_t<T>>,
+                                    std::invoke_result<find_overload<T, std::index_sequence_for<Types...>, Types...>, T>>::type;
 
-    template <typename CurrentType, typename T, typename... Types>
-    struct index_chooser<false, CurrentType, T, Types...> {
-        static constexpr size_t Index = index_chooser<std::is_same_v<T, CurrentType>, CurrentType, Types...>::Index + 1;
-    };
+    template <typename T, typename... Types>
+    constexpr size_t find_index() {
+        constexpr bool matches[] = { std::is_same_v<T, Types>..., false };
+        size_t index = 0;
+        while (index < sizeof...(Types) && !matches[index]) {
+            ++index;
+        }
+        return index;
+    }
 
-    template <typename CurrentType, typename T, typename... Types>
-    inline constexpr size_t index_chooser_v = index_chooser<std::is_same_v<T, CurrentType>, CurrentType, Types...>::Index;
+    template <typename T, typename... Types>
+    inline constexpr size_t index_chooser_v = find_index<T, Types...>();
+
+} // namespace variant_utils
+
+namespace variant_utils {
+
+    struct variant_access {
+        template <size_t Index, typename Variant>
+        static constexpr auto&& get(Variant&& v) noexcept {
+            if constexpr (std::is_lvalue_reference_v<Variant>) {
+                return v.get(in_place_index<Index>);
+            }
+            else {
+                return std::move(v.get(in_place_index<Index>));
+            }
+        }
+    };
 
 } // namespace variant_utils
 
 template <size_t Index, class... Types>
 constexpr variant_alternative_t<Index, variant<Types...>>& get(variant<Types...>& v) {
-    if (Index != v.index()) {
-        throw bad_variant_access();
-    }
+    variant_utils::check_access(Index == v.index());
     return v.get(in_place_index<Index>);
 }
 
@@ -157,9 +315,7 @@ constexpr variant_alternative_t<Index, variant<Types...>>&& get(variant<Types...
 
 template <std::size_t Index, class... Types>
 constexpr const variant_alternative_t<Index, variant<Types...>>& get(const variant<Types...>& v) {
-    if (Index != v.index()) {
-        throw bad_variant_access();
-    }
+    variant_utils::check_access(Index == v.index());
     return v.get(in_place_index<Index>);
 }
 
@@ -195,26 +351,51 @@ namespace variant_utils {
     template <size_t I>
     struct index_wrapper : std::integral_constant<size_t, I> {};
 
-    template <size_t Index, typename... Variants>
-    struct get_next_indexes;
+    template <size_t Size>
+    struct index_holder {
+        size_t value;
 
-    template <size_t Index, typename Variant, typename... Variants>
-    struct get_next_indexes<Index, Variant, Variants...> {
-        using type = typename get_next_indexes<Index - 1, Variants...>::type;
+        constexpr size_t index() const noexcept {
+            return value;
+        }
     };
 
-    template <typename Variant, typename... Variants>
-    struct get_next_indexes<0, Variant, Variants...> {
-        using type = std::make_index_sequence<variant_size_v<std::decay_t<Variant>>>;
-    };
+} // namespace variant_utils
+
+template <size_t Size>
+struct variant_size<variant_utils::index_holder<Size>> : std::integral_constant<size_t, Size> {};
+
+namespace variant_utils {
+
+    template <typename... Variants>
+    inline constexpr size_t flat_size_v = (variant_size_v<std::remove_reference_t<Variants>> * ... * 1);
+
+    template <typename... Variants>
+    constexpr size_t flat_index(Variants const&... vars) {
+        size_t result = 0;
+        ((result = result * variant_size_v<std::remove_reference_t<Variants>> + vars.index()), ...);
+        return result;
+    }
 
-    template <>
-    struct get_next_indexes<0> {
-        using type = std::index_sequence<>;
+    template <typename... Variants>
+    constexpr size_t unflatten_index(size_t flat, size_t position) {
+        constexpr size_t sizes[] = { variant_size_v<std::remove_reference_t<Variants>>... };
+        for (size_t i = sizeof...(Variants) - 1; i > position; --i) {
+            flat /= sizes[i];
+        }
+        return flat % sizes[position];
+    }
+
+    template <size_t Flat, typename Positions, typename... Variants>
+    struct unflatten;
+
+    template <size_t Flat, size_t... Positions, typename... Variants>
+    struct unflatten<Flat, std::index_sequence<Positions...>, Variants...> {
+        using type = std::index_sequence<unflatten_index<Variants...>(Flat, Positions)...>;
     };
 
-    template <size_t Index, typename... Variants>
-    using get_next_indexes_t = typename get_next_indexes<Index, Variants...>::type;
+    template <size_t Flat, typename... Variants>
+    using unflatten_t = typename unflatten<Flat, std::index_sequence_for<Variants...>, Variants...>::type;
 
     template <bool indexed, typename R, typename Visitor, typename Indexes, typename... Variants>
     struct runner;
@@ -222,98 +403,204 @@ namespace variant_utils {
     template <typename R, typename Visitor, size_t... Indexes, typename... Variants>
     struct runner<false, R, Visitor, std::index_sequence<Indexes...>, Variants...> {
         static constexpr R run_func(Visitor vis, Variants... vars) {
-            return std::forward<Visitor>(vis)(::get<Indexes>(std::forward<Variants>(vars))...);
+            return std::forward<Visitor>(vis)(variant_access::get<Indexes>(std::forward<Variants>(vars))...);
         }
     };
 
     template <typename R, typename Visitor, size_t... Indexes, typename... Variants>
     struct runner<true, R, Visitor, std::index_sequence<Indexes...>, Variants...> {
-        static constexpr R run_func(Visitor vis, Variants... vars) {
+        static constexpr R run_func(Visitor vis, Variants...) {
             return std::forward<Visitor>(vis)(index_wrapper<Indexes>{}...);
         }
     };
 
-    template <typename... Args>
-    constexpr std::array<std::common_type_t<Args...>, sizeof...(Args)> make_array(Args&&... args) {
-        return { std::forward<Args>(args)... };
-    }
-
-    template <bool indexed, typename R, typename Visitor, size_t Index, typename PrefixIndexes, typename NextIndexes,
-        typename... Variants>
+    template <bool indexed, typename R, typename Visitor, typename FlatIndexes, typename... Variants>
     struct visit_table;
 
-    template <typename R, typename Visitor, size_t Index, size_t... Indexes, typename... Variants>
-    struct visit_table<false, R, Visitor, Index, std::index_sequence<Indexes...>, std::index_sequence<>, Variants...> {
-
-        static constexpr auto build_next() {
-            return &runner<false, R, Visitor, std::index_sequence<Indexes...>, Variants...>::run_func;
-        }
+    template <bool indexed, typename R, typename Visitor, size_t... Flat, typename... Variants>
+    struct visit_table<indexed, R, Visitor, std::index_sequence<Flat...>, Variants...> {
+        static constexpr std::array<R (*)(Visitor, Variants...), sizeof...(Flat)> value = {
+            &runner<indexed, R, Visitor, unflatten_t<Flat, Variants...>, Variants...>::run_func...
+        };
     };
 
-    template <typename R, typename Visitor, size_t Index, size_t... Indexes, typename... Variants>
-    struct visit_table<true, R, Visitor, Index, std::index_sequence<Indexes...>, std::index_sequence<>, Variants...> {
-        static constexpr auto build_next() {
-            return &runner<true, R, Visitor, std::index_sequence<Indexes...>, Variants...>::run_func;
+    template <bool indexed, typename R, typename Visitor, typename... Variants>
+    inline constexpr auto const& visit_table_v =
+        visit_table<indexed, R, Visitor, std::make_index_sequence<flat_size_v<Variants...>>, Variants...>::value;
+
+    inline constexpr size_t max_switch_cases = 32;
+
+    [[noreturn]] inline void unreachable() {
+#if defined(_MSC_VER) && !defined(__clang__)
+        __assume(false);
+#else
+        __builtin_unreachable();
+#endif
+    }
+
+#define VARIANT_VISIT_CASE(I)                                                                                          \
+    case I:                                                                                                            \
+        if constexpr (I < size) {                                                                                      \
+            return runner<indexed, R, Visitor&&, unflatten_t<I, Variants&&...>, Variants&&...>::run_func(             \
+                std::forward<Visitor>(vis), std::forward<Variants>(vars)...);                                          \
+        }                                                                                                              \
+        else {                                                                                                         \
+            unreachable();                                                                                             \
         }
-    };
 
-    template <bool indexed, typename R, typename Visitor, size_t Index, size_t... PrefixIndexes, size_t... NextIndexes,
-        typename... Variants>
-    struct visit_table<indexed, R, Visitor, Index, std::index_sequence<PrefixIndexes...>,
-        std::index_sequence<NextIndexes...>, Variants...> {
-        static constexpr auto build_next() {
-            return make_array(
-                visit_table<indexed, R, Visitor, Index + 1, std::index_sequence<PrefixIndexes..., NextIndexes>,
-                variant_utils::get_next_indexes_t<Index + 1, Variants...>, Variants...>::build_next()...);
+    template <bool indexed, typename R, typename Visitor, typename... Variants>
+    constexpr R visit_switch(Visitor&& vis, Variants&&... vars) {
+        constexpr size_t size = flat_size_v<Variants...>;
+        static_assert(size <= max_switch_cases);
+        if constexpr (size == 1) {
+            return runner<indexed, R, Visitor&&, unflatten_t<0, Variants&&...>, Variants&&...>::run_func(
+                std::forward<Visitor>(vis), std::forward<Variants>(vars)...);
         }
-    };
+        else {
+            switch (flat_index(vars...)) {
+                VARIANT_VISIT_CASE(0)
+                VARIANT_VISIT_CASE(1)
+                VARIANT_VISIT_CASE(2)
+                VARIANT_VISIT_CASE(3)
+                VARIANT_VISIT_CASE(4)
+                VARIANT_VISIT_CASE(5)
+                VARIANT_VISIT_CASE(6)
+                VARIANT_VISIT_CASE(7)
+                VARIANT_VISIT_CASE(8)
+                VARIANT_VISIT_CASE(9)
+                VARIANT_VISIT_CASE(10)
+                VARIANT_VISIT_CASE(11)
+                VARIANT_VISIT_CASE(12)
+                VARIANT_VISIT_CASE(13)
+                VARIANT_VISIT_CASE(14)
+                VARIANT_VISIT_CASE(15)
+                VARIANT_VISIT_CASE(16)
+                VARIANT_VISIT_CASE(17)
+                VARIANT_VISIT_CASE(18)
+                VARIANT_VISIT_CASE(19)
+                VARIANT_VISIT_CASE(20)
+                VARIANT_VISIT_CASE(21)
+                VARIANT_VISIT_CASE(22)
+                VARIANT_VISIT_CASE(23)
+                VARIANT_VISIT_CASE(24)
+                VARIANT_VISIT_CASE(25)
+                VARIANT_VISIT_CASE(26)
+                VARIANT_VISIT_CASE(27)
+                VARIANT_VISIT_CASE(28)
+                VARIANT_VISIT_CASE(29)
+                VARIANT_VISIT_CASE(30)
+                VARIANT_VISIT_CASE(31)
+            default:
+                unreachable();
+            }
+        }
+    }
+
+#undef VARIANT_VISIT_CASE
 
     template <bool indexed, typename R, typename Visitor, typename... Variants>
-    inline constexpr auto visit_table_v =
-        visit_table<indexed, R, Visitor, 0, std::index_sequence<>, variant_utils::get_next_indexes_t<0, Variants...>,
-        Variants...>::build_next();
+    constexpr R dispatch_uniform(Visitor&& vis, Variants&&... vars) {
+        if constexpr (flat_size_v<Variants...> <= max_switch_cases) {
+            return visit_switch<indexed, R>(std::forward<Visitor>(vis), std::forward<Variants>(vars)...);
+        }
+        else {
+            return visit_table_v<indexed, R, Visitor&&, Variants&&...>[flat_index(vars...)](
+                std::forward<Visitor>(vis), std::forward<Variants>(vars)...);
+        }
+    }
 
-    template <typename Overload>
-    constexpr auto const& get_overload(Overload const& overload) {
-        return overload;
+    template <bool indexed, typename R, size_t... Hot, typename Visitor, typename Variant>
+    constexpr R dispatch_likely(std::index_sequence<Hot...>, Visitor&& vis, Variant&& var) {
+        if constexpr (sizeof...(Hot) == 0) {
+            return dispatch_uniform<indexed, R>(std::forward<Visitor>(vis), std::forward<Variant>(var));
+        }
+        else {
+            constexpr size_t hot[] = { Hot... };
+            static_assert(hot[0] < variant_size_v<std::remove_reference_t<Variant>>, "hot alternative out of range");
+            if (var.index() == hot[0]) [[likely]] {
+                return runner<indexed, R, Visitor&&, std::index_sequence<hot[0]>, Variant&&>::run_func(
+                    std::forward<Visitor>(vis), std::forward<Variant>(var));
+            }
+            return [&]<size_t... Positions>(std::index_sequence<Positions...>) -> R {
+                return dispatch_likely<indexed, R>(std::index_sequence<hot[Positions + 1]...>(),
+                                                   std::forward<Visitor>(vis), std::forward<Variant>(var));
+            }(std::make_index_sequence<sizeof...(Hot) - 1>());
+        }
     }
 
-    template <typename Overload, typename... Is>
-    constexpr auto const& get_overload(Overload const& overload, size_t index, Is... indexes) {
-        return get_overload(overload[index], indexes...);
+    template <bool indexed, typename R, typename Visitor, typename... Variants>
+    constexpr R dispatch(Visitor&& vis, Variants&&... vars) {
+        if constexpr (sizeof...(Variants) == 1) {
+            return dispatch_likely<indexed, R>(typename hot_alternatives<std::remove_cvref_t<Variants>...>::type(),
+                                               std::forward<Visitor>(vis), std::forward<Variants>(vars)...);
+        }
+        else {
+            return dispatch_uniform<indexed, R>(std::forward<Visitor>(vis), std::forward<Variants>(vars)...);
+        }
     }
 
     template <typename Visitor, typename... Variants>
     constexpr decltype(auto) visit_index(Visitor&& vis, Variants&&... vars) {
         using R = decltype(std::invoke(std::forward<Visitor>(vis), get<0>(std::forward<Variants>(vars))...));
-        return variant_utils::get_overload(visit_table_v<true, R, Visitor&&, Variants&&...>,
-            vars.index()...)(std::forward<Visitor>(vis), std::forward<Variants>(vars)...);
+        return variant_utils::dispatch<true, R>(std::forward<Visitor>(vis), std::forward<Variants>(vars)...);
     }
 
     template <typename R, typename Visitor, typename... Variants>
     constexpr R visit_index(Visitor&& vis, Variants&&... vars) {
-        return variant_utils::get_overload(visit_table_v<true, R, Visitor&&, Variants&&...>,
-            vars.index()...)(std::forward<Visitor>(vis), std::forward<Variants>(vars)...);
+        return variant_utils::dispatch<true, R>(std::forward<Visitor>(vis), std::forward<Variants>(vars)...);
     }
 
 } // namespace variant_utils
 
 template <typename Visitor, typename... Variants>
 constexpr decltype(auto) visit(Visitor&& vis, Variants&&... vars) {
-    if ((vars.valueless_by_exception() || ...)) {
-        throw bad_variant_access();
-    }
+    variant_utils::check_access(!(vars.valueless_by_exception() || ...));
+    (VARIANT_COUNT(std::remove_cvref_t<Variants>, visit, vars.index()), ...);
     using R = decltype(std::invoke(std::forward<Visitor>(vis), get<0>(std::forward<Variants>(vars))...));
-    return variant_utils::get_overload(variant_utils::visit_table_v<false, R, Visitor&&, Variants&&...>,
-        vars.index()...)(std::forward<Visitor>(vis), std::forward<Variants>(vars)...);
+    return variant_utils::dispatch<false, R>(std::forward<Visitor>(vis), std::forward<Variants>(vars)...);
 }
 
 template <typename R, typename Visitor, typename... Variants>
 constexpr R visit(Visitor&& vis, Variants&&... vars) {
-    if ((vars.valueless_by_exception() || ...)) {
-        throw bad_variant_access();
+    variant_utils::check_access(!(vars.valueless_by_exception() || ...));
+    (VARIANT_COUNT(std::remove_cvref_t<Variants>, visit, vars.index()), ...);
+    return variant_utils::dispatch<false, R>(std::forward<Visitor>(vis), std::forward<Variants>(vars)...);
+}
+
+template <size_t... Hot, typename Visitor, typename Variant>
+constexpr decltype(auto) visit_likely(Visitor&& vis, Variant&& var) {
+    variant_utils::check_access(!var.valueless_by_exception());
+    VARIANT_COUNT(std::remove_cvref_t<Variant>, visit, var.index());
+    using R = decltype(std::invoke(std::forward<Visitor>(vis), get<0>(std::forward<Variant>(var))));
+    return variant_utils::dispatch_likely<false, R>(std::index_sequence<Hot...>(), std::forward<Visitor>(vis),
+                                                    std::forward<Variant>(var));
+}
+
+namespace variant_utils {
+
+    // HASH
+
+    template <typename T>
+    concept std_hashable = requires(T const& value) {
+        { std::hash<T>{}(value) } -> std::convertible_to<size_t>;
+    };
+
+    constexpr size_t hash_finalize(uint64_t value) noexcept {
+        value ^= value >> 33;
+        value *= 0xff51afd7ed558ccdULL;
+        value ^= value >> 33;
+        value *= 0xc4ceb9fe1a85ec53ULL;
+        value ^= value >> 33;
+        return static_cast<size_t>(value);
+    }
+
+    constexpr size_t hash_mix(size_t seed, size_t value) noexcept {
+        return hash_finalize(seed * 0x9e3779b97f4a7c15ULL + value);
     }
 
-    return variant_utils::get_overload(variant_utils::visit_table_v<false, R, Visitor&&, Variants&&...>,
-        vars.index()...)(std::forward<Visitor>(vis), std::forward<Variants>(vars)...);
-}
\ No newline at end of file
+    template <typename T>
+    size_t hash_alternative(T const& value) {
+        return std::hash<T>{}(value);
+    }
+
+} // namespace variant_utils
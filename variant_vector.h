@@ -0,0 +1,230 @@
+#pragma once
+#include "variant.h"
+#include <span>
+#include <stdexcept>
+#include <tuple>
+#include <vector>
+
+template <typename... Types>
+class variant_vector {
+    static_assert((!std::is_same_v<std::remove_cv_t<Types>, bool> && ...),
+                  "variant_vector: bool alternatives are not supported, std::vector<bool> is not a contiguous pool");
+
+    template <bool is_const>
+    class basic_reference;
+
+public:
+    using value_type = variant<Types...>;
+    using size_type = size_t;
+    using reference = basic_reference<false>;
+    using const_reference = basic_reference<true>;
+
+    variant_vector() = default;
+
+    size_t size() const noexcept {
+        return tags.size();
+    }
+
+    bool empty() const noexcept {
+        return tags.empty();
+    }
+
+    void reserve(size_t capacity) {
+        tags.reserve(capacity);
+        slots.reserve(capacity);
+    }
+
+    void clear() noexcept {
+        tags.clear();
+        slots.clear();
+        std::apply([](auto&... pool) { (pool.clear(), ...); }, pools);
+    }
+
+    reference operator[](size_t position) noexcept {
+        return reference(this, position);
+    }
+
+    const_reference operator[](size_t position) const noexcept {
+        return const_reference(this, position);
+    }
+
+    reference at(size_t position) {
+        check_position(position);
+        return reference(this, position);
+    }
+
+    const_reference at(size_t position) const {
+        check_position(position);
+        return const_reference(this, position);
+    }
+
+    template <size_t Index, typename... Args>
+    variant_alternative_t<Index, value_type>& emplace_back(Args&&... args) {
+        auto& pool = std::get<Index>(pools);
+        if (pool.size() >= std::numeric_limits<slot_type>::max()) {
+            variant_utils::throw_error<std::length_error>("variant_vector: alternative pool is full");
+        }
+        grow_index();
+        auto& result = pool.emplace_back(std::forward<Args>(args)...);
+        tags.push_back(static_cast<tag_type>(Index));
+        slots.push_back(static_cast<slot_type>(pool.size() - 1));
+        return result;
+    }
+
+    template <typename T, typename... Args>
+    T& emplace_back(Args&&... args) {
+        return emplace_back<variant_utils::index_chooser_v<T, Types...>>(std::forward<Args>(args)...);
+    }
+
+    void push_back(value_type const& value) {
+        variant_utils::check_access(!value.valueless_by_exception());
+        variant_utils::visit_index<void>([this, &value](auto index) { this->emplace_back<index>(::get<index>(value)); },
+                                         value);
+    }
+
+    void push_back(value_type&& value) {
+        variant_utils::check_access(!value.valueless_by_exception());
+        variant_utils::visit_index<void>(
+            [this, &value](auto index) { this->emplace_back<index>(::get<index>(std::move(value))); }, value);
+    }
+
+    void pop_back() {
+        dispatch([this](auto index) { std::get<index>(pools).pop_back(); }, tags.size() - 1);
+        tags.pop_back();
+        slots.pop_back();
+    }
+
+    void erase(size_t position) {
+        size_t tag = tags[position];
+        slot_type slot = slots[position];
+        dispatch(
+            [this, slot](auto index) {
+                auto& pool = std::get<index>(pools);
+                pool.erase(pool.begin() + slot);
+            },
+            position);
+        for (size_t i = position + 1; i < tags.size(); ++i) {
+            if (tags[i] == tag) {
+                --slots[i];
+            }
+        }
+        tags.erase(tags.begin() + position);
+        slots.erase(slots.begin() + position);
+    }
+
+    template <size_t Index>
+    std::span<variant_alternative_t<Index, value_type>> alternative() noexcept {
+        return std::get<Index>(pools);
+    }
+
+    template <size_t Index>
+    std::span<const variant_alternative_t<Index, value_type>> alternative() const noexcept {
+        return std::get<Index>(pools);
+    }
+
+    template <typename T>
+    std::span<T> alternative() noexcept {
+        return alternative<variant_utils::index_chooser_v<T, Types...>>();
+    }
+
+    template <typename T>
+    std::span<const T> alternative() const noexcept {
+        return alternative<variant_utils::index_chooser_v<T, Types...>>();
+    }
+
+    std::span<const variant_utils::index_type_t<sizeof...(Types)>> indexes() const noexcept {
+        return tags;
+    }
+
+private:
+    using tag_type = variant_utils::index_type_t<sizeof...(Types)>;
+    using slot_type = uint32_t;
+
+    template <typename Visitor>
+    decltype(auto) dispatch(Visitor&& vis, size_t position) const {
+        using R = decltype(std::forward<Visitor>(vis)(variant_utils::index_wrapper<0>{}));
+        return variant_utils::visit_index<R>(std::forward<Visitor>(vis),
+                                             variant_utils::index_holder<sizeof...(Types)>{ tags[position] });
+    }
+
+    void check_position(size_t position) const {
+        if (position >= size()) {
+            variant_utils::throw_error<std::out_of_range>("variant_vector: position out of range");
+        }
+    }
+
+    void grow_index() {
+        if (tags.size() == tags.capacity()) {
+            size_t capacity = std::max<size_t>(8, tags.capacity() * 2);
+            tags.reserve(capacity);
+            slots.reserve(capacity);
+        }
+    }
+
+    std::vector<tag_type> tags;
+    std::vector<slot_type> slots;
+    std::tuple<std::vector<Types>...> pools;
+};
+
+template <typename... Types>
+template <bool is_const>
+class variant_vector<Types...>::basic_reference {
+    using owner_type = std::conditional_t<is_const, variant_vector const, variant_vector>;
+
+    template <size_t Index>
+    using alternative_type = std::conditional_t<is_const, const variant_alternative_t<Index, value_type>,
+                                                variant_alternative_t<Index, value_type>>;
+
+public:
+    basic_reference(owner_type* owner, size_t position) noexcept : owner(owner), position(position) {}
+
+    operator basic_reference<true>() const noexcept
+        requires(!is_const)
+    {
+        return basic_reference<true>(owner, position);
+    }
+
+    size_t index() const noexcept {
+        return owner->tags[position];
+    }
+
+    template <size_t Index>
+    alternative_type<Index>& get() const {
+        variant_utils::check_access(index() == Index);
+        return std::get<Index>(owner->pools)[owner->slots[position]];
+    }
+
+    template <typename T>
+    auto& get() const {
+        return get<variant_utils::index_chooser_v<T, Types...>>();
+    }
+
+    template <size_t Index>
+    alternative_type<Index>* get_if() const noexcept {
+        if (index() != Index) {
+            return nullptr;
+        }
+        return std::addressof(std::get<Index>(owner->pools)[owner->slots[position]]);
+    }
+
+    template <typename Visitor>
+    decltype(auto) visit(Visitor&& vis) const {
+        return owner->dispatch(
+            [this, &vis](auto index) -> decltype(auto) {
+                return std::forward<Visitor>(vis)(std::get<index>(owner->pools)[owner->slots[position]]);
+            },
+            position);
+    }
+
+    operator value_type() const {
+        return owner->dispatch(
+            [this](auto index) {
+                return value_type(in_place_index<index>, std::get<index>(owner->pools)[owner->slots[position]]);
+            },
+            position);
+    }
+
+private:
+    owner_type* owner;
+    size_t position;
+};